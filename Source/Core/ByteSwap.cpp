@@ -0,0 +1,184 @@
+#include "ByteSwap.h"
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define P64_BYTESWAP_X86 // SSE2 is part of the x86-64 baseline, AVX2 is probed at runtime
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define P64_BYTESWAP_NEON // NEON is part of the AArch64 baseline
+#include <arm_neon.h>
+#endif
+
+#if defined(P64_BYTESWAP_X86) && (defined(__GNUC__) || defined(__clang__))
+#define P64_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define P64_TARGET_AVX2
+#endif
+
+namespace QT_UI {
+
+using ByteSwapKernel = void (*)(char* data, qint64 size);
+
+// Scalar tails, also the fallback on CPUs without a vector path
+
+static void swapBytes16Scalar(char* data, qint64 start, qint64 size)
+{
+    for (qint64 i = start; i + 1 < size; i += 2) {
+        std::swap(data[i], data[i + 1]);
+    }
+}
+
+static void reverseBytes32Scalar(char* data, qint64 start, qint64 size)
+{
+    for (qint64 i = start; i + 3 < size; i += 4) {
+        std::swap(data[i], data[i + 3]);
+        std::swap(data[i + 1], data[i + 2]);
+    }
+}
+
+#ifdef P64_BYTESWAP_X86
+
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX2 also needs the OS to save the YMM registers
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static inline __m128i swap16Sse2(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static void swapBytes16Sse2(char* data, qint64 size)
+{
+    qint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, swap16Sse2(_mm_loadu_si128(p)));
+    }
+    swapBytes16Scalar(data, i, size);
+}
+
+static void reverseBytes32Sse2(char* data, qint64 size)
+{
+    // SSE2 has no byte shuffle: swap the bytes of each half, then the halves
+    qint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        __m128i v = swap16Sse2(_mm_loadu_si128(p));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(p, v);
+    }
+    reverseBytes32Scalar(data, i, size);
+}
+
+P64_TARGET_AVX2 static void shuffleBytesAvx2(char* data, qint64 size, __m256i mask, qint64& done)
+{
+    qint64 i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+    }
+    done = i;
+}
+
+P64_TARGET_AVX2 static void swapBytes16Avx2(char* data, qint64 size)
+{
+    const __m256i mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    qint64 done = 0;
+    shuffleBytesAvx2(data, size, mask, done);
+    swapBytes16Scalar(data, done, size);
+}
+
+P64_TARGET_AVX2 static void reverseBytes32Avx2(char* data, qint64 size)
+{
+    const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    qint64 done = 0;
+    shuffleBytesAvx2(data, size, mask, done);
+    reverseBytes32Scalar(data, done, size);
+}
+
+#endif // P64_BYTESWAP_X86
+
+#ifdef P64_BYTESWAP_NEON
+
+static void swapBytes16Neon(char* data, qint64 size)
+{
+    qint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(p, vrev16q_u8(vld1q_u8(p)));
+    }
+    swapBytes16Scalar(data, i, size);
+}
+
+static void reverseBytes32Neon(char* data, qint64 size)
+{
+    qint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(p, vrev32q_u8(vld1q_u8(p)));
+    }
+    reverseBytes32Scalar(data, i, size);
+}
+
+#endif // P64_BYTESWAP_NEON
+
+static ByteSwapKernel selectSwapBytes16()
+{
+#if defined(P64_BYTESWAP_X86)
+    return cpuHasAvx2() ? swapBytes16Avx2 : swapBytes16Sse2;
+#elif defined(P64_BYTESWAP_NEON)
+    return swapBytes16Neon;
+#else
+    return [](char* data, qint64 size) { swapBytes16Scalar(data, 0, size); };
+#endif
+}
+
+static ByteSwapKernel selectReverseBytes32()
+{
+#if defined(P64_BYTESWAP_X86)
+    return cpuHasAvx2() ? reverseBytes32Avx2 : reverseBytes32Sse2;
+#elif defined(P64_BYTESWAP_NEON)
+    return reverseBytes32Neon;
+#else
+    return [](char* data, qint64 size) { reverseBytes32Scalar(data, 0, size); };
+#endif
+}
+
+void swapBytes16(char* data, qint64 size)
+{
+    static const ByteSwapKernel kernel = selectSwapBytes16();
+    kernel(data, size);
+}
+
+void reverseBytes32(char* data, qint64 size)
+{
+    static const ByteSwapKernel kernel = selectReverseBytes32();
+    kernel(data, size);
+}
+
+} // namespace QT_UI
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QtGlobal>
+
+namespace QT_UI {
+
+/**
+ * In-place byte order kernels for whole ROM images.
+ *
+ * Both work on any writable buffer, including memory-mapped files, and use
+ * the widest vector unit the CPU offers (AVX2 or SSE2 on x86, NEON on ARM),
+ * chosen once at runtime. A trailing partial word is left untouched.
+ */
+
+// Swaps the two bytes of every 16-bit word (.n64 <-> .z64)
+void swapBytes16(char* data, qint64 size);
+
+// Reverses the four bytes of every 32-bit word (.v64 <-> .z64)
+void reverseBytes32(char* data, qint64 size);
+
+} // namespace QT_UI
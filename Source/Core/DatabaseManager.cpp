@@ -4,16 +4,145 @@
 #include <QRegularExpression>
 #include <QSqlDriver>
 #include <QFile>  // Add this include for QFile class
-
-DatabaseManager::DatabaseManager(const QString& dbPath) : m_dbPath(dbPath), m_db(QSqlDatabase::addDatabase("QSQLITE")) {
+#include <QDir>
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadStorage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <atomic>
+
+// In-memory copy of the ROM database. "memdb" databases whose name starts with
+// '/' are shared by every connection in the process, so the copy exists once.
+static const char MEMORY_SNAPSHOT_URI[] = "file:/p64-rom-database?vfs=memdb";
+static const char SNAPSHOT_CONNECTION[] = "DatabaseManager-snapshot";
+static const char SNAPSHOT_SOURCE_CONNECTION[] = "DatabaseManager-snapshot-source";
+
+static std::atomic<bool> s_useMemorySnapshot { false };
+
+DatabaseManager::DatabaseManager(const QString& dbPath, const QString& connectionName)
+    : m_dbPath(dbPath)
+    , m_connectionName(connectionName)
+    , m_db(QSqlDatabase::addDatabase("QSQLITE", connectionName))
+    , m_hasRomBrowserView(false) {
     m_db.setDatabaseName(m_dbPath);
 }
 
+DatabaseManager& DatabaseManager::instance() {
+    // QThreadStorage deletes each thread's manager when that thread finishes,
+    // which closes and unregisters its connection
+    static QThreadStorage<DatabaseManager*> s_threadManagers;
+    
+    if (!s_threadManagers.hasLocalData()) {
+        QString connectionName = QString("DatabaseManager-%1")
+            .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()), 0, 16);
+        
+        // Prefer the shared in-memory snapshot; fall back to the file if it cannot be loaded
+        QString dbPath = defaultDatabasePath();
+        if (s_useMemorySnapshot && loadMemorySnapshot(dbPath)) {
+            dbPath = QLatin1String(MEMORY_SNAPSHOT_URI);
+        }
+        
+        DatabaseManager* manager = new DatabaseManager(dbPath, connectionName);
+        if (!manager->open()) {
+            qWarning() << "Failed to open database at:" << manager->m_dbPath;
+        }
+        s_threadManagers.setLocalData(manager);
+    }
+    
+    return *s_threadManagers.localData();
+}
+
+QString DatabaseManager::defaultDatabasePath() {
+    return QDir(QCoreApplication::applicationDirPath()).filePath("database.sqlite");
+}
+
+void DatabaseManager::setUseMemorySnapshot(bool enabled) {
+    s_useMemorySnapshot = enabled;
+}
+
+bool DatabaseManager::loadMemorySnapshot(const QString& dbPath) {
+    static QMutex mutex;
+    static int state = 0; // 0 = not attempted, 1 = loaded, -1 = failed
+    
+    QMutexLocker locker(&mutex);
+    if (state != 0) {
+        return state > 0;
+    }
+    state = -1;
+    
+    if (!QFile::exists(dbPath)) {
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // The keeper connection is never closed; it keeps the snapshot alive for the
+    // lifetime of the process while per-thread connections come and go
+    QSqlDatabase keeper = QSqlDatabase::addDatabase("QSQLITE", SNAPSHOT_CONNECTION);
+    keeper.setDatabaseName(MEMORY_SNAPSHOT_URI);
+    keeper.setConnectOptions("QSQLITE_OPEN_URI");
+    
+    bool copied = false;
+    if (keeper.open()) {
+        QSqlDatabase source = QSqlDatabase::addDatabase("QSQLITE", SNAPSHOT_SOURCE_CONNECTION);
+        source.setDatabaseName(dbPath);
+        source.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_OPEN_URI");
+        
+        if (source.open()) {
+            // Copies schema, data and indexes in one pass
+            QSqlQuery vacuum(source);
+            vacuum.prepare("VACUUM INTO ?");
+            vacuum.addBindValue(QString(MEMORY_SNAPSHOT_URI));
+            copied = vacuum.exec();
+            if (!copied) {
+                qWarning() << "Failed to copy database into memory:" << vacuum.lastError().text();
+            }
+        } else {
+            qWarning() << "Failed to open database for snapshot:" << source.lastError().text();
+        }
+        source.close();
+    } else {
+        qWarning() << "Failed to create in-memory database:" << keeper.lastError().text();
+    }
+    QSqlDatabase::removeDatabase(SNAPSHOT_SOURCE_CONNECTION);
+    
+    // The snapshot is ours to modify, so the key index is built into it once
+    // and shared by all connections
+    if (copied && !buildRomKeyIndex(keeper, "main")) {
+        copied = false;
+    }
+    
+    if (!copied) {
+        keeper.close();
+        keeper = QSqlDatabase();
+        QSqlDatabase::removeDatabase(SNAPSHOT_CONNECTION);
+        return false;
+    }
+    
+    qDebug() << "Loaded ROM database into memory in" << timer.elapsed() << "ms";
+    state = 1;
+    return true;
+}
+
 DatabaseManager::~DatabaseManager() {
     close();
+    
+    // Named connections belong to a single owner (e.g. a scan worker thread), so
+    // unregister them; the default connection may still be referenced elsewhere
+    if (m_connectionName != QLatin1String(QSqlDatabase::defaultConnection)) {
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
 }
 
 bool DatabaseManager::open() {
+    if (m_dbPath == QLatin1String(MEMORY_SNAPSHOT_URI)) {
+        m_db.setConnectOptions("QSQLITE_OPEN_URI");
+    }
+    
     if (!m_db.open()) {
         qWarning() << "Failed to open database:" << m_db.lastError().text();
         return false;
@@ -26,18 +155,140 @@ bool DatabaseManager::open() {
         logDatabaseSchema();
     }
     
-    // Check if rom_browser_view exists
-    if (!viewExists("rom_browser_view")) {
+    // Check once if rom_browser_view exists; lookups consult the cached flag
+    m_hasRomBrowserView = viewExists("rom_browser_view");
+    if (!m_hasRomBrowserView) {
         qWarning() << "rom_browser_view does not exist in the database, some operations may be slower";
     }
     
+    // The in-memory snapshot already carries the key index; on the database file it is
+    // a TEMP table that lives with this connection and leaves the file untouched
+    QSqlQuery check(m_db);
+    bool hasKeyIndex = check.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'rom_keys'") && check.next();
+    check.finish();
+    if (!hasKeyIndex && !buildRomKeyIndex(m_db, "temp")) {
+        qWarning() << "Failed to build ROM key index, CRC lookups will not match";
+    }
+    
+    applyReadOnlyPragmas();
+    
     return true;
 }
 
+void DatabaseManager::applyReadOnlyPragmas() {
+    // The application never writes the ROM database, so connections are tuned for reads.
+    // query_only comes last; everything after it (TEMP tables included) is read-only.
+    QSqlQuery pragma(m_db);
+    pragma.exec("PRAGMA cache_size = -16384");   // 16 MB, larger than the whole database
+    pragma.exec("PRAGMA mmap_size = 268435456"); // Read the file through mmap (no effect in memory)
+    pragma.exec("PRAGMA temp_store = MEMORY");
+    if (!pragma.exec("PRAGMA query_only = ON")) {
+        qWarning() << "Failed to make database connection read-only:" << pragma.lastError().text();
+    }
+}
+
+bool DatabaseManager::buildRomKeyIndex(QSqlDatabase& db, const QString& schema) {
+    // rom_id strings come in several spellings ("CRC1-CRC2-C:CC", bracketed, without
+    // country), so they are parsed once into an integer key
+    QSqlQuery query(db);
+    if (!query.exec(QString("CREATE TABLE IF NOT EXISTS %1.rom_keys ("
+                            "crc1 INTEGER NOT NULL, crc2 INTEGER NOT NULL, country INTEGER NOT NULL, "
+                            "game_id INTEGER NOT NULL, PRIMARY KEY (crc1, crc2, country, game_id)) WITHOUT ROWID").arg(schema)) ||
+        !query.exec(QString("DELETE FROM %1.rom_keys").arg(schema))) {
+        qWarning() << "Failed to create ROM key table:" << query.lastError().text();
+        return false;
+    }
+    
+    if (!query.exec("SELECT id, rom_id FROM games")) {
+        qWarning() << "Failed to read ROM ids:" << query.lastError().text();
+        return false;
+    }
+    
+    QVariantList crc1s, crc2s, countries, gameIds;
+    while (query.next()) {
+        uint32_t crc1, crc2;
+        int country;
+        if (parseRomId(query.value(1).toString(), crc1, crc2, country)) {
+            crc1s << static_cast<qint64>(crc1);
+            crc2s << static_cast<qint64>(crc2);
+            countries << country;
+            gameIds << query.value(0);
+        }
+    }
+    query.finish();
+    
+    QSqlQuery insert(db);
+    insert.prepare(QString("INSERT OR IGNORE INTO %1.rom_keys (crc1, crc2, country, game_id) VALUES (?, ?, ?, ?)").arg(schema));
+    insert.addBindValue(crc1s);
+    insert.addBindValue(crc2s);
+    insert.addBindValue(countries);
+    insert.addBindValue(gameIds);
+    
+    db.transaction();
+    if (!insert.execBatch()) {
+        qWarning() << "Failed to fill ROM key table:" << insert.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return db.commit();
+}
+
+bool DatabaseManager::parseRomId(const QString& romId, uint32_t& crc1, uint32_t& crc2, int& country) {
+    QString id = romId.trimmed();
+    if (id.startsWith('[') && id.endsWith(']')) {
+        id = id.mid(1, id.length() - 2);
+    }
+    
+    // CRC1-CRC2 with an optional -C:CC country suffix
+    if (id.length() < 17 || id.at(8) != '-') {
+        return false;
+    }
+    
+    bool ok1 = false, ok2 = false;
+    crc1 = id.left(8).toUInt(&ok1, 16);
+    crc2 = id.mid(9, 8).toUInt(&ok2, 16);
+    if (!ok1 || !ok2) {
+        return false;
+    }
+    
+    country = NO_COUNTRY;
+    if (id.length() == 17) {
+        return true;
+    }
+    if (!id.mid(17, 3).startsWith("-C:")) {
+        return false;
+    }
+    
+    bool ok = false;
+    country = id.mid(20).toInt(&ok, 16);
+    return ok;
+}
+
+int DatabaseManager::countryKey(const QString& countryCode) {
+    bool ok = false;
+    int country = normalizeCountryCode(countryCode).toInt(&ok, 16);
+    return ok ? country : NO_COUNTRY;
+}
+
+QString DatabaseManager::romKeyMatchQuery() {
+    // Best match for a CRC pair: the exact country first, then an entry without a
+    // country, then the same CRCs under any other country. Seeks the (crc1, crc2) prefix.
+    return "SELECT game_id FROM rom_keys WHERE crc1 = ? AND crc2 = ? "
+           "ORDER BY country = ? DESC, country = -1 DESC LIMIT 1";
+}
+
+QVariantList DatabaseManager::romKeyBindValues(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
+    return { static_cast<qint64>(crc1), static_cast<qint64>(crc2), countryKey(countryCode) };
+}
+
 void DatabaseManager::close() {
+    // Prepared statements belong to the connection and must go before it closes
+    m_preparedQueries.clear();
+    
     if (m_db.isOpen()) {
         m_db.close();
     }
+    m_hasRomBrowserView = false;
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::getAllGames() {
@@ -52,74 +303,170 @@ std::vector<std::map<QString, QVariant>> DatabaseManager::getAllEnhancements() {
     return executeQuery("SELECT * FROM enhancements");
 }
 
-std::vector<std::map<QString, QVariant>> DatabaseManager::executeQuery(const QString& query) const {
-    std::vector<std::map<QString, QVariant>> results;
+QSqlQuery& DatabaseManager::preparedQuery(const QString& query) const {
+    // Statements are keyed by their SQL text and prepared once per connection,
+    // so repeated lookups only bind values and step the statement
+    auto it = m_preparedQueries.find(query);
+    if (it == m_preparedQueries.end()) {
+        auto q = std::make_unique<QSqlQuery>(m_db);
+        q->setForwardOnly(true);
+        if (!q->prepare(query)) {
+            qWarning() << "Failed to prepare query:" << q->lastError().text() << "Query:" << query;
+        }
+        it = m_preparedQueries.emplace(query, std::move(q)).first;
+    }
+    return *it->second;
+}
 
-    QSqlQuery q(m_db);
-    if (!q.exec(query)) {
-        qWarning() << "Query failed:" << q.lastError().text() << "Query:" << query;
-        return results;
+bool DatabaseManager::execPrepared(QSqlQuery& q, const QVariantList& bindValues) const {
+    for (int i = 0; i < bindValues.size(); ++i) {
+        q.bindValue(i, bindValues.at(i));
     }
+    
+    if (!q.exec()) {
+        qWarning() << "Query failed:" << q.lastError().text() << "Query:" << q.lastQuery();
+        q.finish();
+        return false;
+    }
+    return true;
+}
 
-    while (q.next()) {
+std::vector<std::map<QString, QVariant>> DatabaseManager::executeQuery(const QString& query, const QVariantList& bindValues) const {
+    std::vector<std::map<QString, QVariant>> results;
+    QStringList fieldNames;
+
+    forEachRow(query, bindValues, [&](const QSqlQuery& q) {
+        if (fieldNames.isEmpty()) {
+            const QSqlRecord record = q.record();
+            for (int i = 0; i < record.count(); ++i) {
+                fieldNames << record.fieldName(i);
+            }
+        }
+        
         std::map<QString, QVariant> row;
-        for (int i = 0; i < q.record().count(); ++i) {
-            row[q.record().fieldName(i)] = q.value(i);
+        for (int i = 0; i < fieldNames.size(); ++i) {
+            row[fieldNames.at(i)] = q.value(i);
         }
-        results.push_back(row);
-    }
+        results.push_back(std::move(row));
+    });
 
     return results;
 }
 
-std::map<QString, QVariant> DatabaseManager::executeSingleRowQuery(const QString& query) const {
-    auto results = executeQuery(query);
+std::map<QString, QVariant> DatabaseManager::executeSingleRowQuery(const QString& query, const QVariantList& bindValues) const {
+    auto results = executeQuery(query, bindValues);
     return results.empty() ? std::map<QString, QVariant>() : results.front();
 }
 
-QVariant DatabaseManager::executeSingleValueQuery(const QString& query) const {
-    QSqlQuery q(m_db);
-    if (!q.exec(query) || !q.next()) {
-        return QVariant();
-    }
-    return q.value(0);
+QVariant DatabaseManager::executeSingleValueQuery(const QString& query, const QVariantList& bindValues) const {
+    QVariant value;
+    forEachRow(query, bindValues, [&](const QSqlQuery& q) {
+        if (!value.isValid()) {
+            value = q.value(0);
+        }
+    });
+    return value;
+}
+
+QString DatabaseManager::romBrowserColumns(const QString& tableAlias) {
+    static const QStringList columns = {
+        "id", "rom_id", "good_name", "internal_name", "status", "cartridge_code",
+        "release_date", "release_year", "players", "force_feedback", "region_code",
+        "region_name", "developer_name", "genre_name", "cartridge_color_name",
+        "md5", "sha1", "verified"
+    };
+    
+    QStringList qualified;
+    for (const QString& column : columns) {
+        qualified << tableAlias + "." + column;
+    }
+    return qualified.join(", ");
+}
+
+void DatabaseManager::readRomBrowserEntry(const QSqlQuery& q, RomBrowserEntry& entry) {
+    // Positions follow romBrowserColumns(); the select list is fixed, so no name lookups
+    entry.id = q.value(0).toInt();
+    entry.romId = q.value(1).toString();
+    entry.goodName = q.value(2).toString();
+    entry.internalName = q.value(3).toString();
+    entry.status = q.value(4).toString();
+    entry.cartridgeCode = q.value(5).toString();
+    entry.releaseDate = q.value(6).toString();
+    entry.releaseYear = q.value(7).toInt();
+    entry.players = q.value(8).toInt();
+    entry.forceFeedback = q.value(9).toBool();
+    entry.regionCode = q.value(10).toString();
+    entry.regionName = q.value(11).toString();
+    entry.developerName = q.value(12).toString();
+    entry.genreName = q.value(13).toString();
+    entry.cartridgeColorName = q.value(14).toString();
+    entry.md5 = q.value(15).toString();
+    entry.sha1 = q.value(16).toString();
+    entry.verified = q.value(17).toBool();
+}
+
+RomBrowserEntry DatabaseManager::toRomBrowserEntry(const std::map<QString, QVariant>& row) {
+    RomBrowserEntry entry;
+    if (row.empty()) {
+        return entry;
+    }
+    
+    auto value = [&row](const char* column) {
+        auto it = row.find(column);
+        return it != row.end() ? it->second : QVariant();
+    };
+    
+    entry.id = value("id").toInt();
+    entry.romId = value("rom_id").toString();
+    entry.goodName = value("good_name").toString();
+    entry.internalName = value("internal_name").toString();
+    entry.status = value("status").toString();
+    entry.cartridgeCode = value("cartridge_code").toString();
+    entry.releaseDate = value("release_date").toString();
+    entry.releaseYear = value("release_year").toInt();
+    entry.players = value("players").toInt();
+    entry.forceFeedback = value("force_feedback").toBool();
+    entry.regionCode = value("region_code").toString();
+    entry.regionName = value("region_name").toString();
+    entry.developerName = value("developer_name").toString();
+    entry.genreName = value("genre_name").toString();
+    entry.cartridgeColorName = value("cartridge_color_name").toString();
+    entry.md5 = value("md5").toString();
+    entry.sha1 = value("sha1").toString();
+    entry.verified = value("verified").toBool();
+    return entry;
 }
 
 std::map<QString, QVariant> DatabaseManager::getGameByRomId(const QString& romId) {
-    auto results = executeQuery(QString("SELECT * FROM games WHERE rom_id = '%1'").arg(romId));
-    return results.empty() ? std::map<QString, QVariant>() : results.front();
+    return executeSingleRowQuery("SELECT * FROM games WHERE rom_id = ?", { romId });
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::getAudioSettingsByGameId(int gameId) {
-    return executeQuery(QString("SELECT * FROM audio_settings WHERE game_id = %1").arg(gameId));
+    return executeQuery("SELECT * FROM audio_settings WHERE game_id = ?", { gameId });
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::getCoreSettingsByGameId(int gameId) {
-    return executeQuery(QString("SELECT * FROM core_settings WHERE game_id = %1").arg(gameId));
+    return executeQuery("SELECT * FROM core_settings WHERE game_id = ?", { gameId });
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::getVideoSettingsByGameId(int gameId) {
-    return executeQuery(QString("SELECT * FROM video_settings WHERE game_id = %1").arg(gameId));
+    return executeQuery("SELECT * FROM video_settings WHERE game_id = ?", { gameId });
 }
 
 std::map<QString, QVariant> DatabaseManager::getDeveloperById(int developerId) {
-    auto results = executeQuery(QString("SELECT * FROM developers WHERE id = %1").arg(developerId));
-    return results.empty() ? std::map<QString, QVariant>() : results.front();
+    return executeSingleRowQuery("SELECT * FROM developers WHERE id = ?", { developerId });
 }
 
 std::map<QString, QVariant> DatabaseManager::getGenreById(int genreId) {
-    auto results = executeQuery(QString("SELECT * FROM genres WHERE id = %1").arg(genreId));
-    return results.empty() ? std::map<QString, QVariant>() : results.front();
+    return executeSingleRowQuery("SELECT * FROM genres WHERE id = ?", { genreId });
 }
 
 std::map<QString, QVariant> DatabaseManager::getRegionById(int regionId) {
-    auto results = executeQuery(QString("SELECT * FROM regions WHERE id = %1").arg(regionId));
-    return results.empty() ? std::map<QString, QVariant>() : results.front();
+    return executeSingleRowQuery("SELECT * FROM regions WHERE id = ?", { regionId });
 }
 
 std::map<QString, QVariant> DatabaseManager::getCartridgeColorById(int colorId) {
-    auto results = executeQuery(QString("SELECT * FROM cartridge_colors WHERE id = %1").arg(colorId));
-    return results.empty() ? std::map<QString, QVariant>() : results.front();
+    return executeSingleRowQuery("SELECT * FROM cartridge_colors WHERE id = ?", { colorId });
 }
 
 QString DatabaseManager::createRomIdFromCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
@@ -156,65 +503,8 @@ QString DatabaseManager::normalizeCountryCode(const QString& countryCode) {
     return normalized;
 }
 
-QStringList DatabaseManager::generatePossibleRomIds(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
-    QStringList results;
-    
-    QString formattedCRC1 = formatCRC(crc1);
-    QString formattedCRC2 = formatCRC(crc2);
-    QString normalizedCountry = normalizeCountryCode(countryCode);
-    
-    // Generate various formats that might be in the database
-    
-    // 1. Standard format
-    QString standard = QString("%1-%2-C:%3")
-        .arg(formattedCRC1)
-        .arg(formattedCRC2)
-        .arg(normalizedCountry);
-    results << standard;
-    
-    // 2. With brackets
-    results << QString("[%1]").arg(standard);
-    
-    // 3. Without country code
-    QString withoutCountry = QString("%1-%2")
-        .arg(formattedCRC1)
-        .arg(formattedCRC2);
-    results << withoutCountry;
-    
-    // 4. Without country code with brackets
-    results << QString("[%1]").arg(withoutCountry);
-    
-    // 5. Try common country code alternatives (45=USA, 4A=Japan, 50=Europe, etc.)
-    QStringList commonCountries = {"45", "4A", "50", "49", "53", "55", "46", "58", "59"};
-    for (const QString& cc : commonCountries) {
-        if (cc != normalizedCountry) {
-            results << QString("%1-%2-C:%3")
-                .arg(formattedCRC1)
-                .arg(formattedCRC2)
-                .arg(cc);
-                
-            results << QString("[%1-%2-C:%3]")
-                .arg(formattedCRC1)
-                .arg(formattedCRC2)
-                .arg(cc);
-        }
-    }
-    
-    return results;
-}
-
 int DatabaseManager::getGameIdFromCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
-    QStringList possibleIds = generatePossibleRomIds(crc1, crc2, countryCode);
-    
-    // Build a query with all possible ROM IDs
-    QStringList conditions;
-    for (const QString& id : possibleIds) {
-        conditions << QString("rom_id = '%1'").arg(id);
-    }
-    
-    QString query = QString("SELECT id FROM games WHERE %1 LIMIT 1").arg(conditions.join(" OR "));
-    
-    QVariant result = executeSingleValueQuery(query);
+    QVariant result = executeSingleValueQuery(romKeyMatchQuery(), romKeyBindValues(crc1, crc2, countryCode));
     if (result.isValid()) {
         return result.toInt();
     }
@@ -223,30 +513,18 @@ int DatabaseManager::getGameIdFromCRC(uint32_t crc1, uint32_t crc2, const QStrin
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomInfoByCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
-    QStringList possibleIds = generatePossibleRomIds(crc1, crc2, countryCode);
-    
-    // Build a query with all possible ROM IDs
-    QStringList conditions;
-    for (const QString& id : possibleIds) {
-        conditions << QString("rom_id = '%1'").arg(id);
-    }
-    
-    QString query = QString("SELECT * FROM games WHERE %1 LIMIT 1").arg(conditions.join(" OR "));
+    QString query = QString("SELECT * FROM games WHERE id = (%1)").arg(romKeyMatchQuery());
     
-    return executeSingleRowQuery(query);
+    return executeSingleRowQuery(query, romKeyBindValues(crc1, crc2, countryCode));
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomInfoByCRCWithoutCountry(uint32_t crc1, uint32_t crc2) {
-    // Try to find a ROM by CRC values only, ignoring country code
-    QString crcOnly = QString("%1-%2")
-        .arg(formatCRC(crc1))
-        .arg(formatCRC(crc2));
-    
-    // Try both with and without brackets, using LIKE to match any country code
-    QString query = QString("SELECT * FROM games WHERE rom_id LIKE '%1%' OR rom_id LIKE '[%1]%' LIMIT 1")
-        .arg(crcOnly);
-    
-    return executeSingleRowQuery(query);
+    // Try to find a ROM by CRC values only, ignoring country code. This is a prefix
+    // seek on the key index; an entry without a country (-1) sorts first.
+    return executeSingleRowQuery(
+        "SELECT * FROM games WHERE id = (SELECT game_id FROM rom_keys "
+        "WHERE crc1 = ? AND crc2 = ? ORDER BY country LIMIT 1)",
+        { static_cast<qint64>(crc1), static_cast<qint64>(crc2) });
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomInfoByCartridgeCode(const QString& cartridgeCode) {
@@ -255,10 +533,8 @@ std::map<QString, QVariant> DatabaseManager::getRomInfoByCartridgeCode(const QSt
     }
     
     // Find games with matching cartridge code (exact or partial match)
-    QString query = QString("SELECT * FROM games WHERE cartridge_code = '%1' OR cartridge_code LIKE '%1%' LIMIT 1")
-        .arg(cartridgeCode);
-    
-    return executeSingleRowQuery(query);
+    return executeSingleRowQuery("SELECT * FROM games WHERE cartridge_code = ? OR cartridge_code LIKE ? LIMIT 1",
+                                 { cartridgeCode, cartridgeCode + "%" });
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomInfoByInternalName(const QString& internalName) {
@@ -270,11 +546,8 @@ std::map<QString, QVariant> DatabaseManager::getRomInfoByInternalName(const QStr
     QString cleanedName = internalName;
     cleanedName.remove(QRegularExpression("[^a-zA-Z0-9]")); // Remove special characters
     
-    QString query = QString("SELECT * FROM games WHERE internal_name = '%1' OR internal_name = '%2' LIMIT 1")
-        .arg(internalName)
-        .arg(cleanedName);
-    
-    return executeSingleRowQuery(query);
+    return executeSingleRowQuery("SELECT * FROM games WHERE internal_name = ? OR internal_name = ? LIMIT 1",
+                                 { internalName, cleanedName });
 }
 
 bool DatabaseManager::viewExists(const QString& viewName) const {
@@ -295,7 +568,7 @@ bool DatabaseManager::viewExists(const QString& viewName) const {
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::getAllRomBrowserEntries() {
-    if (!viewExists("rom_browser_view")) {
+    if (!m_hasRomBrowserView) {
         qWarning() << "rom_browser_view not found, falling back to slower method";
         return getAllGames();
     }
@@ -304,36 +577,108 @@ std::vector<std::map<QString, QVariant>> DatabaseManager::getAllRomBrowserEntrie
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomBrowserEntryByCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
-    if (!viewExists("rom_browser_view")) {
+    if (!m_hasRomBrowserView) {
         return getRomCompleteInfo(crc1, crc2, countryCode);
     }
     
-    QStringList possibleIds = generatePossibleRomIds(crc1, crc2, countryCode);
+    QString query = QString("SELECT * FROM rom_browser_view WHERE id = (%1) LIMIT 1").arg(romKeyMatchQuery());
     
-    // Build a query with all possible ROM IDs
-    QStringList conditions;
-    for (const QString& id : possibleIds) {
-        conditions << QString("rom_id = '%1'").arg(id);
+    return executeSingleRowQuery(query, romKeyBindValues(crc1, crc2, countryCode));
+}
+
+RomBrowserEntry DatabaseManager::findRomBrowserEntry(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
+    if (!m_hasRomBrowserView) {
+        return toRomBrowserEntry(getRomCompleteInfo(crc1, crc2, countryCode));
     }
     
-    QString query = QString("SELECT * FROM rom_browser_view WHERE %1 LIMIT 1").arg(conditions.join(" OR "));
+    RomBrowserEntry entry;
+    QString query = QString("SELECT %1 FROM rom_browser_view v WHERE v.id = (%2) LIMIT 1")
+        .arg(romBrowserColumns("v"), romKeyMatchQuery());
     
-    return executeSingleRowQuery(query);
+    forEachRow(query, romKeyBindValues(crc1, crc2, countryCode), [&entry](const QSqlQuery& q) {
+        readRomBrowserEntry(q, entry);
+    });
+    return entry;
+}
+
+std::map<DatabaseManager::RomKey, RomBrowserEntry> DatabaseManager::getRomBrowserEntriesByCRC(const std::vector<RomKey>& keys) {
+    std::map<RomKey, RomBrowserEntry> results;
+    if (keys.empty()) {
+        return results;
+    }
+    
+    if (!m_hasRomBrowserView) {
+        for (const RomKey& key : keys) {
+            RomBrowserEntry entry = findRomBrowserEntry(std::get<0>(key), std::get<1>(key), std::get<2>(key));
+            if (entry.isValid()) {
+                results[key] = std::move(entry);
+            }
+        }
+        return results;
+    }
+    
+    // Pass all keys as one JSON array and resolve them with a single join against the
+    // key index, instead of one round trip per ROM. Nothing is written, so this also
+    // works on read-only connections.
+    QString json;
+    json.reserve(static_cast<int>(keys.size()) * 32);
+    json += '[';
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i > 0) {
+            json += ',';
+        }
+        json += QString("[%1,%2,%3]")
+            .arg(std::get<0>(keys[i]))
+            .arg(std::get<1>(keys[i]))
+            .arg(countryKey(std::get<2>(keys[i])));
+    }
+    json += ']';
+    
+    // Candidates come back best first per key, ranked like romKeyMatchQuery(); the
+    // key's array index follows the entry columns
+    static const int LOOKUP_INDEX_COLUMN = 18;
+    QString query = QString(
+        "SELECT %1, l.key FROM json_each(?) l "
+        "JOIN rom_keys k ON k.crc1 = json_extract(l.value, '$[0]') AND k.crc2 = json_extract(l.value, '$[1]') "
+        "JOIN rom_browser_view v ON v.id = k.game_id "
+        "ORDER BY l.key, k.country = json_extract(l.value, '$[2]') DESC, k.country = -1 DESC").arg(romBrowserColumns("v"));
+    
+    forEachRow(query, { json }, [&](const QSqlQuery& q) {
+        const RomKey& key = keys[q.value(LOOKUP_INDEX_COLUMN).toULongLong()];
+        if (results.count(key)) {
+            return;
+        }
+        readRomBrowserEntry(q, results[key]);
+    });
+    
+    return results;
+}
+
+bool DatabaseManager::findRomHash(const QString& md5, const QString& sha1, bool& verified) {
+    bool found = false;
+    forEachRow("SELECT verified FROM rom_hashes WHERE md5 = ? OR sha1 = ? ORDER BY verified DESC LIMIT 1",
+               { md5.toLower(), sha1.toLower() }, [&](const QSqlQuery& q) {
+        found = true;
+        verified = q.value(0).toBool();
+    });
+    return found;
 }
 
 std::map<QString, QVariant> DatabaseManager::getRomBrowserEntryByRomId(const QString& romId) {
-    if (!viewExists("rom_browser_view")) {
+    if (!m_hasRomBrowserView) {
         return getGameByRomId(romId);
     }
     
-    QString query = QString("SELECT * FROM rom_browser_view WHERE rom_id = '%1' LIMIT 1").arg(romId);
-    return executeSingleRowQuery(query);
+    return executeSingleRowQuery("SELECT * FROM rom_browser_view WHERE rom_id = ? LIMIT 1", { romId });
 }
 
 std::vector<std::map<QString, QVariant>> DatabaseManager::searchRomBrowserEntries(const QString& searchTerm, int limit) {
-    if (!viewExists("rom_browser_view")) {
+    QString pattern = "%" + searchTerm + "%";
+    QVariantList bindValues = { pattern, pattern, pattern, limit };
+    
+    if (!m_hasRomBrowserView) {
         // Fallback to a more complex join query if the view doesn't exist
-        QString query = QString(
+        return executeQuery(
             "SELECT g.*, r.code AS region_code, r.name AS region_name, "
             "d.name AS developer_name, gen.name AS genre_name, cc.name AS cartridge_color_name "
             "FROM games g "
@@ -341,24 +686,20 @@ std::vector<std::map<QString, QVariant>> DatabaseManager::searchRomBrowserEntrie
             "LEFT JOIN developers d ON g.developer_id = d.id "
             "LEFT JOIN genres gen ON g.genre_id = gen.id "
             "LEFT JOIN cartridge_colors cc ON g.cartridge_color_id = cc.id "
-            "WHERE g.good_name LIKE '%%%1%%' OR g.internal_name LIKE '%%%1%%' OR g.cartridge_code LIKE '%%%1%%' "
-            "LIMIT %2").arg(searchTerm).arg(limit);
-        
-        return executeQuery(query);
+            "WHERE g.good_name LIKE ? OR g.internal_name LIKE ? OR g.cartridge_code LIKE ? "
+            "LIMIT ?", bindValues);
     }
     
-    QString query = QString(
+    return executeQuery(
         "SELECT * FROM rom_browser_view "
-        "WHERE good_name LIKE '%%%1%%' OR internal_name LIKE '%%%1%%' OR cartridge_code LIKE '%%%1%%' "
-        "LIMIT %2").arg(searchTerm).arg(limit);
-    
-    return executeQuery(query);
+        "WHERE good_name LIKE ? OR internal_name LIKE ? OR cartridge_code LIKE ? "
+        "LIMIT ?", bindValues);
 }
 
 // Optimize existing method to use the view when possible
 std::map<QString, QVariant> DatabaseManager::getRomCompleteInfo(uint32_t crc1, uint32_t crc2, const QString& countryCode) {
     // Try getting info from the view first if it exists
-    if (viewExists("rom_browser_view")) {
+    if (m_hasRomBrowserView) {
         auto gameInfo = getRomBrowserEntryByCRC(crc1, crc2, countryCode);
         if (!gameInfo.empty()) {
             return gameInfo;
@@ -476,19 +817,16 @@ QString DatabaseManager::getRomSetting(int gameId, const QString& settingName, c
     QString query;
     
     if (category == "core") {
-        query = QString("SELECT setting_value FROM core_settings WHERE game_id = %1 AND setting_name = '%2'")
-                .arg(gameId).arg(settingName);
+        query = "SELECT setting_value FROM core_settings WHERE game_id = ? AND setting_name = ?";
     } else if (category == "video") {
-        query = QString("SELECT setting_value FROM video_settings WHERE game_id = %1 AND setting_name = '%2'")
-                .arg(gameId).arg(settingName);
+        query = "SELECT setting_value FROM video_settings WHERE game_id = ? AND setting_name = ?";
     } else if (category == "audio") {
-        query = QString("SELECT setting_value FROM audio_settings WHERE game_id = %1 AND setting_name = '%2'")
-                .arg(gameId).arg(settingName);
+        query = "SELECT setting_value FROM audio_settings WHERE game_id = ? AND setting_name = ?";
     } else {
         return QString(); // Unknown category
     }
     
-    QVariant result = executeSingleValueQuery(query);
+    QVariant result = executeSingleValueQuery(query, { gameId, settingName });
     return result.isValid() ? result.toString() : QString();
 }
 
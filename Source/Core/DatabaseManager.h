@@ -8,12 +8,53 @@
 #include <QVariant>
 #include <vector>
 #include <map>
+#include <memory>
+#include <tuple>
+
+// Typed row of rom_browser_view, filled by column position without building a
+// per-row map; used by the ROM resolution hot paths
+struct RomBrowserEntry {
+    int id = -1;
+    QString romId;
+    QString goodName;
+    QString internalName;
+    QString status;
+    QString cartridgeCode;
+    QString releaseDate;
+    int releaseYear = 0;
+    int players = 0;
+    bool forceFeedback = false;
+    QString regionCode;
+    QString regionName;
+    QString developerName;
+    QString genreName;
+    QString cartridgeColorName;
+    QString md5;
+    QString sha1;
+    bool verified = false;
+
+    bool isValid() const { return id >= 0; }
+};
 
 class DatabaseManager {
 public:
-    DatabaseManager(const QString& dbPath);
+    // ROM lookup key: (crc1, crc2, country code as in getRomBrowserEntryByCRC)
+    using RomKey = std::tuple<uint32_t, uint32_t, QString>;
+
+    DatabaseManager(const QString& dbPath,
+                    const QString& connectionName = QLatin1String(QSqlDatabase::defaultConnection));
     ~DatabaseManager();
 
+    // Shared per-thread instance on the application database. Each thread gets its own
+    // named SQLite connection, opened on first use and closed when the thread exits,
+    // so lookups from scan workers never reopen the database or share a connection.
+    static DatabaseManager& instance();
+    static QString defaultDatabasePath();
+    
+    // When enabled, instance() connections read from a shared in-memory copy of the
+    // database, loaded once on first use. Set at startup, before the first instance().
+    static void setUseMemorySnapshot(bool enabled);
+
     bool open();
     void close();
 
@@ -81,22 +122,64 @@ public:
     std::vector<std::map<QString, QVariant>> getAllRomBrowserEntries();
     std::map<QString, QVariant> getRomBrowserEntryByCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode);
     std::map<QString, QVariant> getRomBrowserEntryByRomId(const QString& romId);
+    
+    // Typed lookups on rom_browser_view; an invalid entry means no match
+    RomBrowserEntry findRomBrowserEntry(uint32_t crc1, uint32_t crc2, const QString& countryCode);
+    // Resolves many ROMs in one query; keys without a match are absent from the result
+    std::map<RomKey, RomBrowserEntry> getRomBrowserEntriesByCRC(const std::vector<RomKey>& keys);
+    
+    // Looks up full-ROM hashes (Z64 byte order) in rom_hashes; false if neither is known
+    bool findRomHash(const QString& md5, const QString& sha1, bool& verified);
     std::vector<std::map<QString, QVariant>> searchRomBrowserEntries(const QString& searchTerm, int limit = 100);
 
 private:
     QString m_dbPath;
+    QString m_connectionName;
     QSqlDatabase m_db;
+    bool m_hasRomBrowserView;
+    
+    // Prepared statements of this connection, keyed by SQL text
+    mutable std::map<QString, std::unique_ptr<QSqlQuery>> m_preparedQueries;
+    
+    // Query execution helpers; values are bound to '?' placeholders in order
+    QSqlQuery& preparedQuery(const QString& query) const;
+    bool execPrepared(QSqlQuery& q, const QVariantList& bindValues) const;
+    std::vector<std::map<QString, QVariant>> executeQuery(const QString& query, const QVariantList& bindValues = QVariantList()) const;
+    std::map<QString, QVariant> executeSingleRowQuery(const QString& query, const QVariantList& bindValues = QVariantList()) const;
+    QVariant executeSingleValueQuery(const QString& query, const QVariantList& bindValues = QVariantList()) const;
+    
+    // Steps a cached statement and hands each positioned row to the visitor, which
+    // reads columns by index straight from the query
+    template<typename RowVisitor>
+    bool forEachRow(const QString& query, const QVariantList& bindValues, RowVisitor&& visit) const {
+        QSqlQuery& q = preparedQuery(query);
+        if (!execPrepared(q, bindValues)) {
+            return false;
+        }
+        while (q.next()) {
+            visit(q);
+        }
+        q.finish();
+        return true;
+    }
     
-    // Query execution helpers
-    std::vector<std::map<QString, QVariant>> executeQuery(const QString& query) const;
-    std::map<QString, QVariant> executeSingleRowQuery(const QString& query) const;
-    QVariant executeSingleValueQuery(const QString& query) const;
+    // rom_browser_view columns in the order read by readRomBrowserEntry()
+    static QString romBrowserColumns(const QString& tableAlias);
+    static void readRomBrowserEntry(const QSqlQuery& q, RomBrowserEntry& entry);
+    static RomBrowserEntry toRomBrowserEntry(const std::map<QString, QVariant>& row);
     
     // Helper to get game ID from CRC
     int getGameIdFromCRC(uint32_t crc1, uint32_t crc2, const QString& countryCode);
     
-    // Helper to generate multiple ROM ID formats for flexible lookup
-    QStringList generatePossibleRomIds(uint32_t crc1, uint32_t crc2, const QString& countryCode);
+    // Canonical (crc1, crc2, country) key index over games.rom_id, built on open
+    static const int NO_COUNTRY = -1;
+    static bool buildRomKeyIndex(QSqlDatabase& db, const QString& schema);
+    static bool loadMemorySnapshot(const QString& dbPath);
+    void applyReadOnlyPragmas();
+    static bool parseRomId(const QString& romId, uint32_t& crc1, uint32_t& crc2, int& country);
+    static int countryKey(const QString& countryCode);
+    static QString romKeyMatchQuery();
+    static QVariantList romKeyBindValues(uint32_t crc1, uint32_t crc2, const QString& countryCode);
 
     // Helper to check if view exists
     bool viewExists(const QString& viewName) const;
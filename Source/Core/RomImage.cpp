@@ -0,0 +1,192 @@
+#include "RomImage.h"
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace QT_UI {
+
+#ifdef Q_OS_UNIX
+static void adviseMapping(uchar* map, qint64 length, int advice)
+{
+    // Mappings from QFile::map(0, ...) start on a page boundary
+    if (map && length > 0 && madvise(map, static_cast<size_t>(length), advice) != 0) {
+        qDebug() << "madvise failed on ROM mapping";
+    }
+}
+#endif
+
+RomImage::RomImage()
+    : m_map(nullptr)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_convertedSize(0)
+    , m_format(Format_Unknown)
+{
+}
+
+RomImage::~RomImage()
+{
+    close();
+}
+
+bool RomImage::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open ROM file:" << filePath;
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size <= 0) {
+        qWarning() << "ROM file is empty:" << filePath;
+        close();
+        return false;
+    }
+
+    // Copy-on-write, so non-Z64 images can be converted in place without
+    // touching the file; pages that are only read stay shared with the page cache
+    m_map = m_file.map(0, m_size, QFileDevice::MapPrivateOption);
+    if (m_map) {
+        m_data = reinterpret_cast<char*>(m_map);
+#ifdef Q_OS_UNIX
+        // Every user reads the boot area and most read the checksum region after it
+        adviseMapping(m_map, qMin(m_size, RomParser::BOOT_CHECKSUM_END), MADV_WILLNEED);
+#endif
+    } else {
+        // Some file systems cannot be mapped; fall back to reading the file
+        m_buffer = m_file.readAll();
+        if (m_buffer.size() != m_size) {
+            qWarning() << "Failed to read ROM file:" << filePath;
+            close();
+            return false;
+        }
+        m_data = m_buffer.data();
+    }
+
+    m_format = RomParser::detectByteFormat(m_data, m_size);
+    m_convertedSize = 0;
+    return true;
+}
+
+void RomImage::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_convertedSize = 0;
+    m_format = Format_Unknown;
+}
+
+bool RomImage::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+qint64 RomImage::size() const
+{
+    return m_size;
+}
+
+RomByteFormat RomImage::byteFormat() const
+{
+    return m_format;
+}
+
+const char* RomImage::rawData() const
+{
+    return m_data;
+}
+
+const char* RomImage::z64Data(qint64 length)
+{
+    if (m_format != Format_N64 && m_format != Format_V64)
+        return m_data; // Already in Z64 order
+
+    // Convert whole words only, so the next call resumes on a word boundary
+    qint64 end = qMin((length + 3) & ~qint64(3), m_size);
+    if (end > m_convertedSize) {
+        RomParser::convertToZ64InPlace(m_data + m_convertedSize, end - m_convertedSize, m_format);
+        m_convertedSize = end;
+    }
+
+    return m_data;
+}
+
+void RomImage::adviseSequential()
+{
+#ifdef Q_OS_UNIX
+    adviseMapping(m_map, m_size, MADV_SEQUENTIAL);
+#endif
+}
+
+bool RomImage::readHead(const QString& filePath, qint64 length, QByteArray& head, qint64& fileSize)
+{
+#ifdef Q_OS_UNIX
+    // QFile would stat the file on open and read through its own buffer
+    const int fd = ::openat(AT_FDCWD, QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "Failed to open ROM file:" << filePath;
+        return false;
+    }
+
+    if (fileSize < 0) {
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            qWarning() << "Failed to stat ROM file:" << filePath;
+            ::close(fd);
+            return false;
+        }
+        fileSize = status.st_size;
+    }
+
+    // Large reads may come back short; keep reading up to length or EOF
+    head.resize(static_cast<int>(length));
+    qint64 total = 0;
+    while (total < length) {
+        const ssize_t bytesRead = ::pread(fd, head.data() + total, static_cast<size_t>(length - total), total);
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead < 0) {
+            qWarning() << "Failed to read ROM file:" << filePath;
+            ::close(fd);
+            head.clear();
+            return false;
+        }
+        if (bytesRead == 0)
+            break;
+        total += bytesRead;
+    }
+    ::close(fd);
+
+    head.resize(static_cast<int>(total));
+    return true;
+#else
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open ROM file:" << filePath;
+        return false;
+    }
+
+    if (fileSize < 0) {
+        fileSize = file.size();
+    }
+    head = file.read(length);
+    return true;
+#endif
+}
+
+} // namespace QT_UI
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+#include "RomParser.h"
+
+namespace QT_UI {
+
+/**
+ * @brief Read-only, memory-mapped view of a ROM file
+ *
+ * Maps the whole file once so header parsing, CIC detection, checksum
+ * verification and hashing all read the same pages without copying them
+ * into buffers. Z64 images are served straight from the mapping. .n64/.v64
+ * images are mapped copy-on-write and converted to Z64 order in place, only
+ * as far as a caller has asked for, so a header lookup never touches the
+ * rest of the file.
+ *
+ * Not thread-safe; each worker opens its own image.
+ */
+class RomImage {
+public:
+    RomImage();
+    ~RomImage();
+
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    /**
+     * @brief Maps a ROM file and detects its byte order
+     * @return False if the file could not be opened or is empty
+     */
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const;
+
+    qint64 size() const;
+    RomByteFormat byteFormat() const;
+
+    /**
+     * @brief Gets the file contents in their on-disk byte order
+     */
+    const char* rawData() const;
+
+    /**
+     * @brief Gets the image in Z64 byte order, valid for at least the first length bytes
+     *
+     * The pointer stays valid until the image is closed.
+     */
+    const char* z64Data(qint64 length);
+
+    /**
+     * @brief Hints that the whole image is about to be read front to back
+     */
+    void adviseSequential();
+
+    /**
+     * @brief Reads the first length bytes of a ROM file, in on-disk byte order
+     *
+     * For library scans, which only need the header and boot code, and the
+     * checksum pass, which needs the checksum region: one open and positioned
+     * reads, without mapping the file. Pass a fileSize already known from the
+     * directory listing to skip the fstat(); otherwise pass -1.
+     * @param fileSize Receives the file size if it was not known
+     * @return False if the file could not be opened or read
+     */
+    static bool readHead(const QString& filePath, qint64 length, QByteArray& head, qint64& fileSize);
+
+private:
+    QFile m_file;
+    uchar* m_map;
+    QByteArray m_buffer;  // Holds the contents if the file cannot be mapped
+    char* m_data;
+    qint64 m_size;
+    qint64 m_convertedSize;
+    RomByteFormat m_format;
+};
+
+} // namespace QT_UI
@@ -1,5 +1,9 @@
 #include "RomInfoProvider.h"
 #include "RomParser.h"
+#include "RomImage.h"
+#include "ZipArchive.h"
+#include "SevenZipIndex.h"
+#include "StringPool.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QSettings>
@@ -9,15 +13,13 @@
 
 namespace QT_UI {
 
-// Initialize static country names map
-QMap<CountryCode, QString> RomInfoProvider::m_countryNames;
-
 RomInfoProvider::RomInfoProvider() : 
     m_romSize(0),
     m_country(Country_Unknown),
     m_cicChip(CIC_UNKNOWN),
     m_crc1(0),
     m_crc2(0),
+    m_checksumValid(true),
     m_fileFormat(Format_Uncompressed),
     m_byteFormat(Format_Unknown),
     m_developer(""),
@@ -29,90 +31,148 @@ RomInfoProvider::RomInfoProvider() :
     m_status("Unknown"),
     m_romParser(new RomParser())
 {
-    if (m_countryNames.isEmpty()) {
-        initializeCountryNames();
-    }
-    
-    // Initialize DatabaseManager with path to the database
-    QString dbPath = QDir(QCoreApplication::applicationDirPath()).filePath("database.sqlite");
-    m_dbManager = new DatabaseManager(dbPath);
-    
-    // Open database connection
-    if (!m_dbManager->open()) {
-        qWarning() << "Failed to open database at:" << dbPath;
-    }
+    // Providers are created per ROM, possibly on scan worker threads, so use the
+    // shared connection of the calling thread instead of opening the database each time
+    m_dbManager = &DatabaseManager::instance();
 }
 
 RomInfoProvider::~RomInfoProvider()
 {
     delete m_romParser;
-    delete m_dbManager; // Clean up database manager
 }
 
-void RomInfoProvider::initializeCountryNames()
+bool RomInfoProvider::openRomFile(const QString& filePath, bool loadDatabaseInfo, const QString& memberName)
 {
-    m_countryNames[Country_USA] = "USA";
-    m_countryNames[Country_Germany] = "Germany";
-    m_countryNames[Country_Japan] = "Japan";
-    m_countryNames[Country_Europe] = "Europe";
-    m_countryNames[Country_Italy] = "Italy";
-    m_countryNames[Country_Spain] = "Spain";
-    m_countryNames[Country_Australia] = "Australia";
-    m_countryNames[Country_France] = "France";
-    m_countryNames[Country_Unknown2] = "PAL";
-    m_countryNames[Country_Unknown3] = "PAL";
-    m_countryNames[Country_Unknown] = "Unknown";
+    if (isArchive(filePath)) {
+        QVector<ArchivedRom> roms;
+        if (!readArchivedRoms(filePath, roms)) {
+            return false;
+        }
+        
+        if (roms.isEmpty()) {
+            qWarning() << "No ROM found in archive:" << filePath;
+            return false;
+        }
+        
+        // Without a member name the first ROM stands for the whole archive
+        for (const ArchivedRom& rom : roms) {
+            if (memberName.isEmpty() || rom.memberName == memberName) {
+                return openArchivedRom(filePath, rom, loadDatabaseInfo);
+            }
+        }
+        
+        qWarning() << "ROM" << memberName << "not found in archive:" << filePath;
+        return false;
+    }
+    
+    m_filePath = filePath;
+    m_memberName.clear();
+    m_fileName = QFileInfo(filePath).fileName();
+    m_fileFormat = Format_Uncompressed;
+    
+    // Header parsing, CIC detection and the checksum all work on the start of
+    // the ROM in Z64 order, straight from the mapping
+    RomImage image;
+    if (!image.open(filePath)) {
+        return false;
+    }
+    
+    m_byteFormat = image.byteFormat();
+    m_romSize = image.size();
+    const qint64 bootSize = qMin(image.size(), RomParser::BOOT_CHECKSUM_END);
+    return parseBootArea(image.z64Data(bootSize), bootSize, loadDatabaseInfo);
 }
 
-bool RomInfoProvider::openRomFile(const QString& filePath)
+bool RomInfoProvider::openRomHead(const QString& filePath, const QByteArray& head, qint64 fileSize, bool loadDatabaseInfo)
 {
     m_filePath = filePath;
+    m_memberName.clear();
+    m_fileName = QFileInfo(filePath).fileName();
+    m_fileFormat = Format_Uncompressed;
     
-    QFileInfo fileInfo(filePath);
-    m_fileName = fileInfo.fileName();
+    QByteArray bootArea = head.left(static_cast<int>(RomParser::BOOT_AREA_SIZE));
+    m_byteFormat = RomParser::detectByteFormat(bootArea.constData(), bootArea.size());
+    RomParser::convertToZ64InPlace(bootArea.data(), bootArea.size(), m_byteFormat);
+    m_romSize = fileSize;
     
-    // Determine file format
-    QString extension = fileInfo.suffix().toLower();
-    if (extension == "zip") {
-        m_fileFormat = Format_Zip;
-        // TODO: Extract ROM data from zip
-        return false; // Not implemented for this example
-    }
-    else if (extension == "7z") {
-        m_fileFormat = Format_7zip;
-        // TODO: Extract ROM data from 7z
-        return false; // Not implemented for this example
-    }
-    else {
-        m_fileFormat = Format_Uncompressed;
+    return parseBootArea(bootArea.constData(), bootArea.size(), loadDatabaseInfo);
+}
+
+bool RomInfoProvider::isArchive(const QString& filePath)
+{
+    return filePath.endsWith(".zip", Qt::CaseInsensitive) || filePath.endsWith(".7z", Qt::CaseInsensitive);
+}
+
+QString RomInfoProvider::romKey(const QString& filePath, const QString& memberName)
+{
+    // An archive is a file, so no real file path can start with "<archive>/"
+    return memberName.isEmpty() ? filePath : filePath + '/' + memberName;
+}
+
+bool RomInfoProvider::readArchivedRoms(const QString& filePath, QVector<ArchivedRom>& roms)
+{
+    roms.clear();
+    
+    if (filePath.endsWith(".7z", Qt::CaseInsensitive)) {
+        // Reaching a member of a solid archive means decoding everything
+        // before it, so the heads come from the index, which decodes each
+        // archive once per modification
+        QVector<SevenZipIndex::Member> members;
+        if (!SevenZipIndex::instance().romMembers(filePath, members)) {
+            return false;
+        }
+        
+        for (const SevenZipIndex::Member& member : members) {
+            roms.append(ArchivedRom{ member.entry.name, member.entry.size, member.head });
+        }
+        return true;
     }
     
-    // Read ROM header - first 64 bytes
-    QFile romFile(filePath);
-    if (!romFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open ROM file:" << filePath;
+    // The central directory lists every member without decompressing
+    // anything; each ROM then costs a few KB of inflation
+    ZipArchive archive;
+    if (!archive.open(filePath)) {
         return false;
     }
     
-    m_RomHeader = romFile.read(0x40); // Read first 64 bytes header
-    if (m_RomHeader.size() < 0x40) {
-        qWarning() << "ROM file too small:" << filePath;
-        return false;
+    for (const ZipArchive::Entry& entry : archive.romEntries()) {
+        roms.append(ArchivedRom{ entry.name, entry.uncompressedSize, archive.read(entry, RomParser::BOOT_AREA_SIZE) });
     }
+    return true;
+}
+
+bool RomInfoProvider::openArchivedRom(const QString& filePath, const ArchivedRom& rom, bool loadDatabaseInfo)
+{
+    m_filePath = filePath;
+    m_memberName = rom.memberName;
+    m_fileName = QFileInfo(rom.memberName).fileName();
+    m_fileFormat = filePath.endsWith(".7z", Qt::CaseInsensitive) ? Format_7zip : Format_Zip;
+    
+    // Only the boot area was decompressed; the checksum region would cost a
+    // megabyte of decompression per ROM, so archived ROMs are not verified
+    QByteArray bootArea = rom.head;
+    m_byteFormat = RomParser::detectByteFormat(bootArea.constData(), bootArea.size());
+    RomParser::convertToZ64InPlace(bootArea.data(), bootArea.size(), m_byteFormat);
+    m_romSize = rom.size;
     
-    // Set the header data in the parser
-    m_romParser->setRomData(m_RomHeader);
+    return parseBootArea(bootArea.constData(), bootArea.size(), loadDatabaseInfo);
+}
+
+bool RomInfoProvider::parseBootArea(const char* bootData, qint64 bootSize, bool loadDatabaseInfo)
+{
+    if (bootSize < RomParser::HEADER_SIZE) {
+        qWarning() << "ROM file too small:" << romKey(m_filePath, m_memberName);
+        return false;
+    }
     
-    // Detect ROM byte format (Z64, N64, V64)
-    m_byteFormat = m_romParser->detectByteFormat();
     // Only log format if it's unusual
     if (m_byteFormat == Format_Unknown) {
-        qWarning() << "Unknown ROM format detected for:" << filePath;
+        qWarning() << "Unknown ROM format detected for:" << romKey(m_filePath, m_memberName);
     }
     
-    // Get ROM size
-    m_romSize = romFile.size();
-    romFile.close();
+    // The parser keeps its own copy of the 4 KB boot area (header and IPL3),
+    // since it outlives the mapping
+    m_romParser->setRomData(QByteArray(bootData, qMin(bootSize, RomParser::BOOT_AREA_SIZE)));
     
     // Parse header information
     parseRomHeader();
@@ -123,8 +183,13 @@ bool RomInfoProvider::openRomFile(const QString& filePath)
     // Detect CIC chip based on ROM header information
     detectCICChip();
     
+    // Check the stored CRCs against the ROM contents
+    verifyBootChecksum(bootData, bootSize);
+    
     // Load ROM database information
-    loadRomInformation();
+    if (loadDatabaseInfo) {
+        loadRomInformation();
+    }
     
     return true;
 }
@@ -157,14 +222,22 @@ bool RomInfoProvider::loadRomInformation()
     return true;
 }
 
-void RomInfoProvider::loadRDBInfo()
+QString RomInfoProvider::databaseCountryCode() const
 {
     // Get the country code byte from the parser
     unsigned char countryByte = m_romParser->getRawCountryByte();
     
     // Format country code consistently with database format (hex value without sign extension)
-    QString countryHex = QString::number(countryByte, 16).toUpper().rightJustified(2, '0');
-    
+    return QString::number(countryByte, 16).toUpper().rightJustified(2, '0');
+}
+
+DatabaseManager::RomKey RomInfoProvider::getRomKey() const
+{
+    return DatabaseManager::RomKey(m_crc1, m_crc2, databaseCountryCode());
+}
+
+void RomInfoProvider::loadRDBInfo()
+{
     // Check if database is usable
     if (!m_dbManager || !m_dbManager->isDatabaseLoaded()) {
         qWarning() << "Database is not loaded, ROM info cannot be retrieved";
@@ -172,46 +245,30 @@ void RomInfoProvider::loadRDBInfo()
     }
     
     // Use the optimized rom_browser_view to get ROM information in a single query
-    auto gameInfo = m_dbManager->getRomBrowserEntryByCRC(m_crc1, m_crc2, countryHex);
-    
-    if (!gameInfo.empty()) {
+    applyDatabaseInfo(m_dbManager->findRomBrowserEntry(m_crc1, m_crc2, databaseCountryCode()));
+}
+
+void RomInfoProvider::applyDatabaseInfo(const RomBrowserEntry& entry)
+{
+    if (entry.isValid()) {
         // Process ROM info silently - only log if needed for diagnostics
-        if (gameInfo.count("good_name") && gameInfo["good_name"].isValid()) {
-            m_goodName = gameInfo["good_name"].toString();
-        }
-        
-        if (gameInfo.count("status") && gameInfo["status"].isValid()) {
-            m_status = gameInfo["status"].toString();
-        }
-        
-        if (gameInfo.count("internal_name") && gameInfo["internal_name"].isValid() && m_internalName.isEmpty()) {
-            m_internalName = gameInfo["internal_name"].toString();
-        }
-        
-        if (gameInfo.count("developer_name") && gameInfo["developer_name"].isValid()) {
-            m_developer = gameInfo["developer_name"].toString();
-        }
-        
-        if (gameInfo.count("release_date") && gameInfo["release_date"].isValid()) {
-            m_releaseDate = gameInfo["release_date"].toString();
-        }
-        
-        if (gameInfo.count("genre_name") && gameInfo["genre_name"].isValid()) {
-            m_genre = gameInfo["genre_name"].toString();
-        }
+        // Values repeated across the library share one pooled copy
+        StringPool& pool = StringPool::instance();
+        m_goodName = entry.goodName;
+        m_status = pool.shared(entry.status);
         
-        if (gameInfo.count("players") && gameInfo["players"].isValid()) {
-            m_players = gameInfo["players"].toInt();
+        if (m_internalName.isEmpty()) {
+            m_internalName = entry.internalName;
         }
         
-        if (gameInfo.count("force_feedback") && gameInfo["force_feedback"].isValid()) {
-            m_forceFeedback = gameInfo["force_feedback"].toBool();
-        }
+        m_developer = pool.shared(entry.developerName);
+        m_releaseDate = pool.shared(entry.releaseDate);
+        m_genre = pool.shared(entry.genreName);
+        m_players = entry.players;
+        m_forceFeedback = entry.forceFeedback;
         
         // Map cartridge_code to productID as mentioned in the requirements
-        if (gameInfo.count("cartridge_code") && gameInfo["cartridge_code"].isValid()) {
-            m_productID = gameInfo["cartridge_code"].toString();
-        }
+        m_productID = entry.cartridgeCode;
         
         // Single summary debug message instead of multiple per-property messages
         qDebug() << "ROM info loaded:" << m_goodName << "(" << m_status << ")";
@@ -221,6 +278,10 @@ void RomInfoProvider::loadRDBInfo()
                  << QString::number(m_crc1, 16).toUpper() << "-" 
                  << QString::number(m_crc2, 16).toUpper();
         
+        if (!m_dbManager || !m_dbManager->isDatabaseLoaded()) {
+            return;
+        }
+        
         // Try fallback lookups if not found by CRC
         auto gameInfoByCartridge = m_dbManager->getRomInfoByCartridgeCode(m_cartID);
         if (!gameInfoByCartridge.empty()) {
@@ -259,6 +320,11 @@ QString RomInfoProvider::getFileName() const
     return m_fileName;
 }
 
+QString RomInfoProvider::getMemberName() const
+{
+    return m_memberName;
+}
+
 QString RomInfoProvider::getGoodName() const
 {
     return m_goodName;
@@ -276,7 +342,7 @@ QString RomInfoProvider::getMediaType() const
     if (mediaType != "N64 Cartridge" && !mediaType.isEmpty()) {
         qDebug() << "Non-standard media type detected:" << mediaType;
     }
-    return mediaType;
+    return StringPool::instance().shared(mediaType);
 }
 
 int RomInfoProvider::getRomSize() const
@@ -286,7 +352,7 @@ int RomInfoProvider::getRomSize() const
 
 QString RomInfoProvider::getCountryName() const
 {
-    return countryCodeToName(m_country);
+    return StringPool::instance().shared(countryCodeToName(m_country));
 }
 
 CountryCode RomInfoProvider::getCountryCode() const
@@ -357,6 +423,27 @@ RomByteFormat RomInfoProvider::getByteFormat() const
     return m_byteFormat;
 }
 
+bool RomInfoProvider::isChecksumValid() const
+{
+    return m_checksumValid;
+}
+
+void RomInfoProvider::verifyBootChecksum(const char* z64Data, qint64 size)
+{
+    m_checksumValid = true;
+    
+    uint32_t crc1 = 0, crc2 = 0;
+    if (!RomParser::calculateBootChecksum(z64Data, size, m_cicChip, crc1, crc2))
+        return;
+    
+    if (crc1 != m_crc1 || crc2 != m_crc2) {
+        m_checksumValid = false;
+        qDebug() << "Boot checksum mismatch for" << m_fileName << "- header:"
+                 << QString::number(m_crc1, 16).toUpper() << QString::number(m_crc2, 16).toUpper()
+                 << "computed:" << QString::number(crc1, 16).toUpper() << QString::number(crc2, 16).toUpper();
+    }
+}
+
 // Add getter for status
 QString RomInfoProvider::getStatus() const
 {
@@ -365,7 +452,22 @@ QString RomInfoProvider::getStatus() const
 
 QString RomInfoProvider::countryCodeToName(CountryCode countryCode)
 {
-    return m_countryNames.value(countryCode, "Unknown");
+    // Built once, thread-safely; providers run on scanner worker threads
+    static const QMap<CountryCode, QString> countryNames = {
+        { Country_USA, "USA" },
+        { Country_Germany, "Germany" },
+        { Country_Japan, "Japan" },
+        { Country_Europe, "Europe" },
+        { Country_Italy, "Italy" },
+        { Country_Spain, "Spain" },
+        { Country_Australia, "Australia" },
+        { Country_France, "France" },
+        { Country_Unknown2, "PAL" },
+        { Country_Unknown3, "PAL" },
+        { Country_Unknown, "Unknown" }
+    };
+
+    return countryNames.value(countryCode, "Unknown");
 }
 
 CountryCode RomInfoProvider::charToCountryCode(char countryChar)
@@ -385,49 +487,21 @@ CountryCode RomInfoProvider::charToCountryCode(char countryChar)
     }
 }
 
-// Update CICChip detection in openRomFile or parseRomHeader method
 void RomInfoProvider::detectCICChip() 
 {
-    // The CIC chip can often be detected by examining the ROM data at specific offsets
-    // Here's a simplified detection method based on common CIC patterns
-
-    // Default to unknown
-    m_cicChip = CIC_UNKNOWN;
-    
-    // Check if we have enough data
-    if (m_RomHeader.size() < 0x40)
+    // Retail boot code is identified exactly by its hash
+    m_cicChip = m_romParser->detectCICChip();
+    if (m_cicChip != CIC_UNKNOWN)
         return;
-        
-    // Detect based on the ROM header checksum at 0x10-0x13 and other characteristics
-    uint32_t crc1 = m_crc1;
     
-    // Common CIC chip detection patterns (simplified approach)
-    if (crc1 == 0x587BD543 || crc1 == 0x90D68C10 || crc1 == 0xA5CC4F95) {
-        m_cicChip = CIC_NUS_6101;  // Also used by StarFox 64
-    } else if (crc1 == 0xE24DD796 || crc1 == 0x900DDE47) {
-        m_cicChip = CIC_NUS_6102;  // Common NTSC CIC
-    } else if (crc1 == 0xB8B51D35 || crc1 == 0x49207DCE || crc1 == 0x9BBDF07D) {
-        m_cicChip = CIC_NUS_6103;  // Common PAL CIC
-    } else if (crc1 == 0x0B050EE0 || crc1 == 0xC8379994 || crc1 == 0x0E711C63) {
-        m_cicChip = CIC_NUS_6105;  // Used by Zelda, F-Zero X, etc.
-    } else if (crc1 == 0xD5BE5580 || crc1 == 0xB98A9A45) {
-        m_cicChip = CIC_NUS_6106;  // Rare PAL CIC
-    } else if (m_cartID == "NA" && getMediaType().contains("ALECK64")) {
+    // Boards whose boot code is not in the parser's table
+    if (m_cartID == "NA" && getMediaType().contains("ALECK64")) {
         m_cicChip = CIC_NUS_5167;  // Aleck64 arcade board
     } else if (getMediaType().contains("64DD")) {
         m_cicChip = CIC_NUS_8303;  // 64DD
     } else {
-        // Default to most common CIC chip if we can't detect
-        if (m_country == Country_USA || m_country == Country_Japan) {
-            m_cicChip = CIC_NUS_6102;  // NTSC default
-        } else {
-            m_cicChip = CIC_NUS_6103;  // PAL default
-        }
-    }
-    
-    // Only log unusual CIC chips
-    if (m_cicChip != CIC_NUS_6102 && m_cicChip != CIC_NUS_6103 && m_cicChip != CIC_UNKNOWN) {
-        qDebug() << "Non-standard CIC chip detected:" << m_cicChip;
+        // Custom boot code (homebrew, some hacks) or a damaged boot area
+        qDebug() << "Unrecognized IPL3 boot code in" << m_fileName;
     }
 }
 
@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QVector>
 #include <QMap>
 #include "RomParser.h" // Include parser to get enum types
 #include "DatabaseManager.h" // Add DatabaseManager include
@@ -13,11 +14,41 @@ public:
     RomInfoProvider();
     ~RomInfoProvider();
     
-    bool openRomFile(const QString& filePath);
+    // A ROM inside a ZIP or 7z archive, as listed by readArchivedRoms()
+    struct ArchivedRom {
+        QString memberName;
+        qint64 size = 0;
+        QByteArray head; // Up to RomParser::BOOT_AREA_SIZE bytes, in the member's byte order
+    };
+    
+    // Without database info only the header is parsed; the caller can resolve
+    // getRomKey() itself (e.g. in a batch) and pass the entry to applyDatabaseInfo().
+    // For archives memberName picks the ROM; by default the first one is used.
+    bool openRomFile(const QString& filePath, bool loadDatabaseInfo = true, const QString& memberName = QString());
+    
+    // Parses a plain ROM file from its first bytes as read by RomImage::readHead().
+    // The boot checksum needs the first megabyte, so it is not verified here.
+    bool openRomHead(const QString& filePath, const QByteArray& head, qint64 fileSize, bool loadDatabaseInfo = true);
+    
+    // Parses one ROM listed by readArchivedRoms(), without opening the archive again
+    bool openArchivedRom(const QString& filePath, const ArchivedRom& rom, bool loadDatabaseInfo = true);
+    
+    // Lists the ROMs in an archive with the start of each, without
+    // decompressing anything else; false if it is not a readable archive
+    static bool readArchivedRoms(const QString& filePath, QVector<ArchivedRom>& roms);
+    static bool isArchive(const QString& filePath);
+    
+    // Identifies a ROM in the library: its file path, extended by the member
+    // name for ROMs inside archives
+    static QString romKey(const QString& filePath, const QString& memberName);
+    
+    DatabaseManager::RomKey getRomKey() const;
+    void applyDatabaseInfo(const RomBrowserEntry& entry);
     
     // Basic ROM information
     QString getInternalName() const;
     QString getFileName() const;
+    QString getMemberName() const; // Empty unless the ROM is inside an archive
     QString getGoodName() const;
     QString getCartID() const;
     QString getMediaType() const;
@@ -31,6 +62,9 @@ public:
     CICChip getCICChip() const;
     uint32_t getCRC1() const;
     uint32_t getCRC2() const;
+    // False if the boot checksum contradicts the header CRCs (bad dump or
+    // modified ROM); ROMs whose checksum cannot be computed are not flagged
+    bool isChecksumValid() const;
     QString getManufacturerID() const;
     RomFileFormat getFileFormat() const;
     
@@ -47,12 +81,14 @@ public:
     RomByteFormat getByteFormat() const;
     
 private:
-    void initializeCountryNames();
     void parseRomHeader();
     void calculateCRC();
+    bool parseBootArea(const char* bootData, qint64 bootSize, bool loadDatabaseInfo);
     bool loadRomInformation();
     void loadRDBInfo();
+    QString databaseCountryCode() const;
     void detectCICChip();  // Add this declaration
+    void verifyBootChecksum(const char* z64Data, qint64 size);
     
     // Static helper methods
     static QString countryCodeToName(CountryCode countryCode);
@@ -60,16 +96,17 @@ private:
     
     // ROM information
     QString m_filePath;
+    QString m_memberName;
     QString m_fileName;
     QString m_internalName;
     QString m_goodName;
     QString m_cartID;
     int m_romSize;
     CountryCode m_country;
-    QByteArray m_RomHeader;
     CICChip m_cicChip;
     uint32_t m_crc1;
     uint32_t m_crc2;
+    bool m_checksumValid;
     RomFileFormat m_fileFormat;
     
     // Game information
@@ -81,16 +118,13 @@ private:
     QString m_productID;
     QString m_status;  // New field for compatibility status
     
-    // Static country name mapping
-    static QMap<CountryCode, QString> m_countryNames;
-
     // ROM byte format
     RomByteFormat m_byteFormat;
     
     // ROM parser
     RomParser* m_romParser;
 
-    // Add DatabaseManager
+    // Shared per-thread database connection (not owned)
     DatabaseManager* m_dbManager;
 };
 
@@ -1,8 +1,41 @@
 #include "RomParser.h"
+#include "ByteSwap.h"
 #include <QDebug>
+#include <QtEndian>
+#include <array>
 
 namespace QT_UI {
 
+// Reflected CRC-32 (IEEE 802.3), the checksum ROM sets list next to MD5/SHA-1
+static constexpr std::array<uint32_t, 256> makeCrc32Table()
+{
+    std::array<uint32_t, 256> table {};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+static constexpr std::array<uint32_t, 256> CRC32_TABLE = makeCrc32Table();
+
+// CRC-32 of the IPL3 boot code (0x40-0x1000, Z64 order) of each retail CIC
+struct CicBootCode {
+    uint32_t crc32;
+    CICChip cic;
+};
+
+static constexpr CicBootCode CIC_BOOT_CODES[] = {
+    { 0x6170A4A1, CIC_NUS_6101 },
+    { 0x009E9EA3, CIC_NUS_6101 }, // NUS-7102 (Lylat Wars), checksummed like 6101
+    { 0x90BB6CB5, CIC_NUS_6102 }, // Also NUS-7101
+    { 0x0B050EE0, CIC_NUS_6103 }, // Also NUS-7103
+    { 0x98BC2C86, CIC_NUS_6105 }, // Also NUS-7105
+    { 0xACC8580A, CIC_NUS_6106 }, // Also NUS-7106
+};
+
 RomParser::RomParser() : m_detectedFormat(Format_Unknown)
 {
 }
@@ -27,15 +60,20 @@ bool RomParser::setRomData(const QByteArray& headerData)
 
 RomByteFormat RomParser::detectByteFormat() const
 {
-    if (m_headerData.size() < 4) {
+    return detectByteFormat(m_headerData.constData(), m_headerData.size());
+}
+
+RomByteFormat RomParser::detectByteFormat(const char* data, qint64 size)
+{
+    if (size < 4) {
         return Format_Unknown;
     }
     
     // Extract the first 4 bytes as unsigned values
-    uint32_t magic = ((static_cast<uint32_t>(static_cast<unsigned char>(m_headerData[0])) << 24) |
-                       (static_cast<uint32_t>(static_cast<unsigned char>(m_headerData[1])) << 16) |
-                       (static_cast<uint32_t>(static_cast<unsigned char>(m_headerData[2])) << 8) |
-                       (static_cast<uint32_t>(static_cast<unsigned char>(m_headerData[3]))));
+    uint32_t magic = ((static_cast<uint32_t>(static_cast<unsigned char>(data[0])) << 24) |
+                       (static_cast<uint32_t>(static_cast<unsigned char>(data[1])) << 16) |
+                       (static_cast<uint32_t>(static_cast<unsigned char>(data[2])) << 8) |
+                       (static_cast<uint32_t>(static_cast<unsigned char>(data[3]))));
     
     // Check against known magic values
     if (magic == 0x80371240) {
@@ -47,7 +85,7 @@ RomByteFormat RomParser::detectByteFormat() const
     }
     
     // If no match, try a more lenient check based on the first byte
-    unsigned char firstByte = static_cast<unsigned char>(m_headerData[0]);
+    unsigned char firstByte = static_cast<unsigned char>(data[0]);
     if (firstByte == 0x80) {
         return Format_Z64;
     } else if (firstByte == 0x37) {
@@ -64,41 +102,36 @@ RomByteFormat RomParser::detectByteFormat() const
     return Format_Z64;
 }
 
-QByteArray RomParser::convertToZ64Format(RomByteFormat sourceFormat) const
+void RomParser::convertToZ64InPlace(char* data, qint64 size, RomByteFormat sourceFormat)
 {
-    if (sourceFormat == Format_Z64 || sourceFormat == Format_Unknown) {
-        return m_headerData; // Already in Z64 format or unknown format
-    }
-    
-    QByteArray converted(m_headerData.size(), 0);
-    
+    // Only whole words are converted; ROM images are always a multiple of 4 bytes
     if (sourceFormat == Format_N64) {
         // N64 format: bytes are swapped within 16-bit words (middle-endian)
-        for (int i = 0; i < m_headerData.size(); i += 2) {
-            if (i + 1 < m_headerData.size()) {
-                converted[i] = m_headerData[i + 1];
-                converted[i + 1] = m_headerData[i];
-            } else if (i < m_headerData.size()) {
-                converted[i] = m_headerData[i]; // Handle odd byte at the end
-            }
-        }
+        swapBytes16(data, size);
     } else if (sourceFormat == Format_V64) {
         // V64 format: completely reversed byte order (little-endian)
-        for (int i = 0; i < m_headerData.size(); i += 4) {
-            if (i + 3 < m_headerData.size()) {
-                converted[i] = m_headerData[i + 3];
-                converted[i + 1] = m_headerData[i + 2];
-                converted[i + 2] = m_headerData[i + 1];
-                converted[i + 3] = m_headerData[i];
-            } else {
-                // Handle partial word at the end
-                for (int j = 0; j < m_headerData.size() - i; j++) {
-                    converted[i + j] = m_headerData[m_headerData.size() - 1 - j];
-                }
-            }
-        }
+        reverseBytes32(data, size);
+    }
+}
+
+uint32_t RomParser::updateCrc32(uint32_t crc, const char* data, qint64 size)
+{
+    crc = ~crc;
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+    for (qint64 i = 0; i < size; ++i)
+        crc = CRC32_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+QByteArray RomParser::convertToZ64Format(RomByteFormat sourceFormat) const
+{
+    if (sourceFormat == Format_Z64 || sourceFormat == Format_Unknown) {
+        return m_headerData; // Already in Z64 format or unknown format
     }
     
+    // Convert a private copy through the raw pointer, so no per-byte detach checks
+    QByteArray converted(m_headerData.constData(), m_headerData.size());
+    convertToZ64InPlace(converted.data(), converted.size(), sourceFormat);
     return converted;
 }
 
@@ -190,6 +223,22 @@ QString RomParser::extractMediaType() const
     }
 }
 
+CICChip RomParser::detectCICChip() const
+{
+    if (m_headerZ64.size() < BOOT_AREA_SIZE) {
+        return CIC_UNKNOWN;
+    }
+    
+    const uint32_t crc = updateCrc32(0, m_headerZ64.constData() + HEADER_SIZE, BOOT_AREA_SIZE - HEADER_SIZE);
+    for (const CicBootCode& bootCode : CIC_BOOT_CODES) {
+        if (bootCode.crc32 == crc) {
+            return bootCode.cic;
+        }
+    }
+    
+    return CIC_UNKNOWN;
+}
+
 void RomParser::calculateCRC(uint32_t& crc1, uint32_t& crc2) const
 {
     if (m_headerZ64.size() >= 0x18) {
@@ -212,6 +261,79 @@ void RomParser::calculateCRC(uint32_t& crc1, uint32_t& crc2) const
     }
 }
 
+// The IPL3 boot code of every CIC checksums the first 1 MB after the header
+// with the same mixing function, seeded differently per CIC. This is the hot
+// loop of a library verify pass, so the 6105 variant, which additionally mixes
+// in words of its own boot code, is a separate instantiation instead of a
+// branch per word.
+template <bool Cic6105>
+static void bootChecksumRounds(const uchar* bytes, uint32_t seed, uint32_t t[6])
+{
+    uint32_t t1 = seed, t2 = seed, t3 = seed, t4 = seed, t5 = seed, t6 = seed;
+    
+    for (qint64 i = RomParser::BOOT_CHECKSUM_START; i < RomParser::BOOT_CHECKSUM_END; i += 4) {
+        const uint32_t d = qFromBigEndian<quint32>(bytes + i);
+        
+        const uint32_t sum = t6 + d;
+        t4 += (sum < t6); // Carry out of t6
+        t6 = sum;
+        t3 ^= d;
+        
+        const uint32_t shift = d & 0x1F;
+        const uint32_t r = shift ? (d << shift) | (d >> (32 - shift)) : d;
+        t5 += r;
+        t2 ^= (t2 > d) ? r : (t6 ^ d);
+        
+        if (Cic6105) {
+            t1 += qFromBigEndian<quint32>(bytes + 0x0750 + (i & 0xFF)) ^ d;
+        } else {
+            t1 += t5 ^ d;
+        }
+    }
+    
+    t[0] = t1; t[1] = t2; t[2] = t3; t[3] = t4; t[4] = t5; t[5] = t6;
+}
+
+bool RomParser::calculateBootChecksum(const char* data, qint64 size, CICChip cic,
+                                      uint32_t& crc1, uint32_t& crc2)
+{
+    uint32_t seed = 0;
+    switch (cic) {
+        case CIC_NUS_6101:
+        case CIC_NUS_6102: seed = 0xF8CA4DDC; break;
+        case CIC_NUS_6103: seed = 0xA3886759; break;
+        case CIC_NUS_6105: seed = 0xDF26F436; break;
+        case CIC_NUS_6106: seed = 0x1FEA617A; break;
+        default: return false; // Aleck64, 64DD and iQue boot code is not checksummed this way
+    }
+    
+    if (size < BOOT_CHECKSUM_END) {
+        return false;
+    }
+    
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+    uint32_t t[6];
+    if (cic == CIC_NUS_6105) {
+        bootChecksumRounds<true>(bytes, seed, t);
+    } else {
+        bootChecksumRounds<false>(bytes, seed, t);
+    }
+    
+    const uint32_t t1 = t[0], t2 = t[1], t3 = t[2], t4 = t[3], t5 = t[4], t6 = t[5];
+    if (cic == CIC_NUS_6103) {
+        crc1 = (t6 ^ t4) + t3;
+        crc2 = (t5 ^ t2) + t1;
+    } else if (cic == CIC_NUS_6106) {
+        crc1 = (t6 * t4) + t3;
+        crc2 = (t5 * t2) + t1;
+    } else {
+        crc1 = t6 ^ t4 ^ t3;
+        crc2 = t5 ^ t2 ^ t1;
+    }
+    
+    return true;
+}
+
 unsigned char RomParser::getRawCountryByte() const
 {
     if (m_headerZ64.size() <= 0x3E) {
@@ -49,10 +49,18 @@ enum RomByteFormat {
 
 class RomParser {
 public:
+    // Layout of the 4 KB boot area: 64-byte header followed by the IPL3 boot code
+    static constexpr qint64 HEADER_SIZE = 0x40;
+    static constexpr qint64 BOOT_AREA_SIZE = 0x1000;
+    
+    // Bytes the boot checksum covers: the first 1 MB after the boot area
+    static constexpr qint64 BOOT_CHECKSUM_START = BOOT_AREA_SIZE;
+    static constexpr qint64 BOOT_CHECKSUM_END = 0x101000;
+    
     RomParser();
     ~RomParser();
     
-    // Set the ROM data for parsing
+    // Set the ROM data for parsing: at least the header, ideally the whole boot area
     bool setRomData(const QByteArray& headerData);
     
     // Format detection and conversion
@@ -60,13 +68,26 @@ public:
     QByteArray convertToZ64Format(RomByteFormat sourceFormat) const;
     uint32_t byteSwap32(uint32_t value, RomByteFormat sourceFormat) const;
     
+    // Buffer-level helpers for streaming whole ROMs (e.g. hashing) in chunks
+    static RomByteFormat detectByteFormat(const char* data, qint64 size);
+    static void convertToZ64InPlace(char* data, qint64 size, RomByteFormat sourceFormat);
+    static uint32_t updateCrc32(uint32_t crc, const char* data, qint64 size);
+    
     // Header information extraction
     QString extractInternalName() const;
     QString extractCartID() const;
     CountryCode extractCountryCode() const;
     QString extractMediaType() const;
+    
+    // Identifies the CIC from a hash of the IPL3 boot code; needs the whole boot area
+    CICChip detectCICChip() const;
     void calculateCRC(uint32_t& crc1, uint32_t& crc2) const;
     
+    // Computes the CIC-seeded boot checksum over Z64 data holding at least
+    // BOOT_CHECKSUM_END bytes; false if the CIC has no known seed or data is short
+    static bool calculateBootChecksum(const char* data, qint64 size, CICChip cic,
+                                      uint32_t& crc1, uint32_t& crc2);
+    
     // Get raw country code byte for database lookups
     unsigned char getRawCountryByte() const;
 
@@ -45,6 +45,11 @@ int ApplicationSettings::maxRecentRomDirs() const
     return SettingsManager::instance().value("General/MaxRecentRomDirs", 10).toInt();
 }
 
+bool ApplicationSettings::loadDatabaseIntoMemory() const
+{
+    return SettingsManager::instance().value("General/LoadDatabaseIntoMemory", true).toBool();
+}
+
 // Theme settings
 ApplicationSettings::Theme ApplicationSettings::theme() const
 {
@@ -132,6 +137,14 @@ void ApplicationSettings::setMaxRecentRomDirs(int max)
     }
 }
 
+void ApplicationSettings::setLoadDatabaseIntoMemory(bool load)
+{
+    if (loadDatabaseIntoMemory() != load) {
+        SettingsManager::instance().setValue("General/LoadDatabaseIntoMemory", load);
+        emit generalSettingsChanged();
+    }
+}
+
 void ApplicationSettings::setTheme(Theme theme)
 {
     if (this->theme() != theme) {
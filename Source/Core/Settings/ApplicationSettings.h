@@ -38,6 +38,7 @@ public:
     bool hideAdvancedSettings() const;
     int maxRecentRoms() const;
     int maxRecentRomDirs() const;
+    bool loadDatabaseIntoMemory() const;
 
     // Theme settings
     Theme theme() const;
@@ -58,6 +59,7 @@ public:
     void setHideAdvancedSettings(bool hide);
     void setMaxRecentRoms(int max);
     void setMaxRecentRomDirs(int max);
+    void setLoadDatabaseIntoMemory(bool load);
     void setTheme(Theme theme);
     void setMainWindowGeometry(const QByteArray& geometry);
     void setMainWindowState(const QByteArray& state);
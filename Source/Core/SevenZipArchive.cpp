@@ -0,0 +1,936 @@
+#include "SevenZipArchive.h"
+#include "RomParser.h"
+#include "ZipArchive.h"
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <lzma.h>
+
+// LZMA1EXT (LZMA1 with a known uncompressed size) arrived in liblzma 5.4.0
+#if LZMA_VERSION >= 50040002
+#define SEVENZIP_HAVE_LZMA1EXT 1
+#else
+#define SEVENZIP_HAVE_LZMA1EXT 0
+#endif
+
+namespace QT_UI {
+
+// Signature header: magic, version, start header CRC, then the next header's
+// offset (relative to the end of this header), size and CRC
+static const char SIGNATURE[] = { '7', 'z', '\xBC', '\xAF', '\x27', '\x1C' };
+static const qint64 SIGNATURE_HEADER_SIZE = 32;
+
+// Property IDs from 7-Zip's 7zFormat.txt
+enum PropertyId : quint64 {
+    kEnd = 0x00,
+    kHeader = 0x01,
+    kArchiveProperties = 0x02,
+    kAdditionalStreamsInfo = 0x03,
+    kMainStreamsInfo = 0x04,
+    kFilesInfo = 0x05,
+    kPackInfo = 0x06,
+    kUnPackInfo = 0x07,
+    kSubStreamsInfo = 0x08,
+    kSize = 0x09,
+    kCRC = 0x0A,
+    kFolder = 0x0B,
+    kCodersUnPackSize = 0x0C,
+    kNumUnPackStream = 0x0D,
+    kEmptyStream = 0x0E,
+    kEmptyFile = 0x0F,
+    kName = 0x11,
+    kEncodedHeader = 0x17
+};
+
+// Sanity limits against corrupt headers
+static const quint64 MAX_CODERS = 64;
+static const quint64 MAX_FILES = 1 << 20;
+
+// Compressed bytes read from the archive per step
+static const qint64 INPUT_BUFFER_SIZE = 64 * 1024;
+
+// Decoded bytes handed on per step
+static const qint64 OUTPUT_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Bounds-checked reader over a decoded header. Any read past the end marks
+ * the reader as failed and returns zeros, so parsers only check ok() at
+ * structural points.
+ */
+class SevenZipArchive::HeaderReader {
+public:
+    explicit HeaderReader(const QByteArray& data)
+        : m_data(data), m_pos(0), m_ok(true)
+    {
+    }
+
+    bool ok() const { return m_ok; }
+    qint64 pos() const { return m_pos; }
+    qint64 remaining() const { return m_data.size() - m_pos; }
+
+    void seek(qint64 pos)
+    {
+        if (pos < 0 || pos > m_data.size()) {
+            m_ok = false;
+            return;
+        }
+        m_pos = pos;
+    }
+
+    quint8 byte()
+    {
+        if (m_pos >= m_data.size()) {
+            m_ok = false;
+            return 0;
+        }
+        return static_cast<quint8>(m_data.at(m_pos++));
+    }
+
+    // 7z variable-length number: leading one bits of the first byte count the extra bytes
+    quint64 number()
+    {
+        const quint8 first = byte();
+        quint8 mask = 0x80;
+        quint64 value = 0;
+        for (int i = 0; i < 8; ++i) {
+            if ((first & mask) == 0) {
+                const quint64 high = first & (mask - 1);
+                return value | (high << (8 * i));
+            }
+            value |= quint64(byte()) << (8 * i);
+            mask >>= 1;
+        }
+        return value;
+    }
+
+    quint32 uint32()
+    {
+        quint32 value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= quint32(byte()) << (8 * i);
+        return value;
+    }
+
+    QByteArray bytes(quint64 count)
+    {
+        if (count > quint64(remaining())) {
+            m_ok = false;
+            return QByteArray();
+        }
+        QByteArray result = m_data.mid(m_pos, qint64(count));
+        m_pos += qint64(count);
+        return result;
+    }
+
+    // Bit vector, most significant bit first
+    QVector<bool> bits(quint64 count)
+    {
+        if ((count + 7) / 8 > quint64(remaining())) {
+            m_ok = false;
+            return QVector<bool>();
+        }
+        QVector<bool> result(static_cast<qint64>(count));
+        quint8 current = 0;
+        for (quint64 i = 0; i < count; ++i) {
+            if (i % 8 == 0)
+                current = byte();
+            result[qint64(i)] = (current & (0x80 >> (i % 8))) != 0;
+        }
+        return result;
+    }
+
+    // Bit vector preceded by an "all defined" flag byte
+    QVector<bool> optionalBits(quint64 count)
+    {
+        if (byte() != 0)
+            return QVector<bool>(qint64(count), true);
+        return bits(count);
+    }
+
+    // Guards counts read from the header before they size an allocation
+    bool plausibleCount(quint64 count, quint64 limit)
+    {
+        if (count > limit || count > quint64(remaining()) + 1)
+            m_ok = false;
+        return m_ok;
+    }
+
+private:
+    QByteArray m_data;
+    qint64 m_pos;
+    bool m_ok;
+};
+
+struct SevenZipArchive::StreamsInfo {
+    quint64 packPos = 0;
+    QVector<quint64> packSizes;
+    QVector<Folder> folders;
+    QVector<bool> folderHasCrc;
+    QVector<quint32> folderCrcs;
+    QVector<quint64> folderStreamCounts; // Members per folder
+    QVector<qint64> streamSizes;         // One per member with data, in folder order
+    QVector<bool> streamHasCrc;
+    QVector<quint32> streamCrcs;
+};
+
+qint64 SevenZipArchive::Folder::unpackSize() const
+{
+    // The folder's output is the one coder out stream no bind pair consumes
+    for (int i = 0; i < unpackSizes.size(); ++i) {
+        bool bound = false;
+        for (const auto& pair : bindPairs) {
+            if (pair.second == quint64(i)) {
+                bound = true;
+                break;
+            }
+        }
+        if (!bound)
+            return qint64(unpackSizes.at(i));
+    }
+    return 0;
+}
+
+SevenZipArchive::SevenZipArchive()
+{
+}
+
+SevenZipArchive::~SevenZipArchive()
+{
+    close();
+}
+
+bool SevenZipArchive::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open 7z archive:" << filePath;
+        return false;
+    }
+
+    const QByteArray signature = m_file.read(SIGNATURE_HEADER_SIZE);
+    const char* s = signature.constData();
+    if (signature.size() != SIGNATURE_HEADER_SIZE || memcmp(s, SIGNATURE, sizeof(SIGNATURE)) != 0 ||
+        RomParser::updateCrc32(0, s + 12, 20) != qFromLittleEndian<quint32>(s + 8)) {
+        qWarning() << "Not a 7z archive:" << filePath;
+        close();
+        return false;
+    }
+
+    const quint64 nextHeaderOffset = qFromLittleEndian<quint64>(s + 12);
+    const quint64 nextHeaderSize = qFromLittleEndian<quint64>(s + 20);
+    const quint32 nextHeaderCrc = qFromLittleEndian<quint32>(s + 28);
+    if (nextHeaderSize == 0)
+        return true; // Empty archive
+
+    const quint64 fileSize = quint64(m_file.size());
+    if (nextHeaderOffset > fileSize || nextHeaderSize > fileSize - nextHeaderOffset ||
+        !m_file.seek(SIGNATURE_HEADER_SIZE + qint64(nextHeaderOffset))) {
+        qWarning() << "Truncated 7z archive:" << filePath;
+        close();
+        return false;
+    }
+
+    QByteArray header = m_file.read(qint64(nextHeaderSize));
+    if (header.size() != qint64(nextHeaderSize) ||
+        RomParser::updateCrc32(0, header.constData(), header.size()) != nextHeaderCrc) {
+        qWarning() << "Corrupt 7z header:" << filePath;
+        close();
+        return false;
+    }
+
+    // Archives written by 7-Zip usually compress the header itself; it is
+    // described by a streams info block and decoded like any folder
+    for (int depth = 0; depth < 4; ++depth) {
+        HeaderReader reader(header);
+        const quint64 id = reader.number();
+
+        if (id == kHeader) {
+            if (readHeader(reader))
+                return true;
+            break;
+        }
+
+        if (id != kEncodedHeader)
+            break;
+
+        StreamsInfo info;
+        if (!readStreamsInfo(reader, info) || info.folders.isEmpty())
+            break;
+
+        QByteArray decoded;
+        const Folder& folder = info.folders.first();
+        decoded.reserve(folder.unpackSize());
+        const bool ok = decodeFolder(folder, [&](const char* data, qint64 size) {
+            decoded.append(data, size);
+            return true;
+        });
+        if (!ok || (info.folderHasCrc.value(0) &&
+                    RomParser::updateCrc32(0, decoded.constData(), decoded.size()) != info.folderCrcs.value(0)))
+            break;
+
+        header = decoded;
+    }
+
+    qWarning() << "Unsupported or corrupt 7z header:" << filePath;
+    close();
+    return false;
+}
+
+void SevenZipArchive::close()
+{
+    m_file.close();
+    m_entries.clear();
+    m_folders.clear();
+}
+
+const QVector<SevenZipArchive::Entry>& SevenZipArchive::entries() const
+{
+    return m_entries;
+}
+
+QVector<SevenZipArchive::Entry> SevenZipArchive::romEntries() const
+{
+    QVector<Entry> roms;
+    for (const Entry& entry : m_entries) {
+        if (ZipArchive::isRomFileName(entry.name))
+            roms.append(entry);
+    }
+    return roms;
+}
+
+bool SevenZipArchive::readHeader(HeaderReader& reader)
+{
+    quint64 id = reader.number();
+
+    if (id == kArchiveProperties) {
+        for (quint64 type = reader.number(); type != kEnd && reader.ok(); type = reader.number())
+            reader.bytes(reader.number());
+        id = reader.number();
+    }
+
+    if (id == kAdditionalStreamsInfo) {
+        StreamsInfo additional;
+        if (!readStreamsInfo(reader, additional))
+            return false;
+        id = reader.number();
+    }
+
+    StreamsInfo info;
+    if (id == kMainStreamsInfo) {
+        if (!readStreamsInfo(reader, info))
+            return false;
+        id = reader.number();
+    }
+
+    if (id == kFilesInfo) {
+        if (!readFilesInfo(reader, info))
+            return false;
+        id = reader.number();
+    }
+
+    m_folders = info.folders;
+    return reader.ok() && id == kEnd;
+}
+
+bool SevenZipArchive::readStreamsInfo(HeaderReader& reader, StreamsInfo& info)
+{
+    bool haveSubStreams = false;
+
+    for (;;) {
+        const quint64 id = reader.number();
+        if (!reader.ok())
+            return false;
+
+        if (id == kEnd)
+            break;
+
+        if (id == kPackInfo) {
+            info.packPos = reader.number();
+            const quint64 count = reader.number();
+            if (!reader.plausibleCount(count, MAX_FILES))
+                return false;
+
+            for (quint64 type = reader.number(); type != kEnd && reader.ok(); type = reader.number()) {
+                if (type == kSize) {
+                    for (quint64 i = 0; i < count; ++i)
+                        info.packSizes.append(reader.number());
+                } else if (type == kCRC) {
+                    const QVector<bool> defined = reader.optionalBits(count);
+                    for (bool isDefined : defined) {
+                        if (isDefined)
+                            reader.uint32();
+                    }
+                } else {
+                    return false;
+                }
+            }
+        } else if (id == kUnPackInfo) {
+            if (reader.number() != kFolder)
+                return false;
+            const quint64 folderCount = reader.number();
+            if (!reader.plausibleCount(folderCount, MAX_FILES) || reader.byte() != 0) // External folders are not used
+                return false;
+
+            for (quint64 i = 0; i < folderCount; ++i) {
+                Folder folder;
+                const quint64 coderCount = reader.number();
+                if (!reader.plausibleCount(coderCount, MAX_CODERS) || coderCount == 0)
+                    return false;
+
+                quint64 totalIn = 0, totalOut = 0;
+                for (quint64 c = 0; c < coderCount; ++c) {
+                    const quint8 flags = reader.byte();
+                    if (flags & 0x80) // Alternative methods were never written by 7-Zip
+                        return false;
+
+                    Coder coder;
+                    coder.id = reader.bytes(flags & 0x0F);
+                    if (flags & 0x10) {
+                        coder.inStreams = reader.number();
+                        coder.outStreams = reader.number();
+                    }
+                    if (flags & 0x20) {
+                        coder.properties = reader.bytes(reader.number());
+                    }
+                    totalIn += coder.inStreams;
+                    totalOut += coder.outStreams;
+                    folder.coders.append(coder);
+                }
+
+                if (!reader.ok() || totalOut == 0 || totalIn > MAX_CODERS || totalOut > MAX_CODERS || totalIn < totalOut - 1)
+                    return false;
+
+                for (quint64 b = 0; b + 1 < totalOut; ++b) {
+                    const quint64 in = reader.number();
+                    const quint64 out = reader.number();
+                    folder.bindPairs.append(qMakePair(in, out));
+                }
+
+                const quint64 packedCount = totalIn - (totalOut - 1);
+                if (packedCount == 1) {
+                    // The packed stream is the one in stream no bind pair feeds
+                    for (quint64 in = 0; in < totalIn; ++in) {
+                        bool bound = false;
+                        for (const auto& pair : folder.bindPairs)
+                            bound = bound || pair.first == in;
+                        if (!bound) {
+                            folder.packedStreams.append(in);
+                            break;
+                        }
+                    }
+                } else {
+                    for (quint64 p = 0; p < packedCount; ++p)
+                        folder.packedStreams.append(reader.number());
+                }
+
+                folder.unpackSizes.resize(qint64(totalOut));
+                info.folders.append(folder);
+            }
+
+            if (reader.number() != kCodersUnPackSize)
+                return false;
+            for (Folder& folder : info.folders) {
+                for (quint64& size : folder.unpackSizes)
+                    size = reader.number();
+            }
+
+            info.folderHasCrc = QVector<bool>(info.folders.size(), false);
+            info.folderCrcs = QVector<quint32>(info.folders.size(), 0);
+            for (quint64 type = reader.number(); type != kEnd && reader.ok(); type = reader.number()) {
+                if (type != kCRC)
+                    return false;
+                info.folderHasCrc = reader.optionalBits(quint64(info.folders.size()));
+                for (int f = 0; f < info.folderHasCrc.size(); ++f) {
+                    if (info.folderHasCrc.at(f))
+                        info.folderCrcs[f] = reader.uint32();
+                }
+            }
+        } else if (id == kSubStreamsInfo) {
+            haveSubStreams = true;
+            info.folderStreamCounts = QVector<quint64>(info.folders.size(), 1);
+
+            quint64 type = reader.number();
+            if (type == kNumUnPackStream) {
+                for (quint64& count : info.folderStreamCounts) {
+                    count = reader.number();
+                    if (!reader.plausibleCount(count, MAX_FILES))
+                        return false;
+                }
+                type = reader.number();
+            }
+
+            // Sizes of all but the last member of a folder are stored; the
+            // last one takes the rest of the folder
+            const bool haveSizes = type == kSize;
+            for (int f = 0; f < info.folders.size(); ++f) {
+                const quint64 count = info.folderStreamCounts.at(f);
+                if (count == 0)
+                    continue;
+                if (count > 1 && !haveSizes)
+                    return false;
+
+                qint64 sum = 0;
+                for (quint64 s = 1; s < count; ++s) {
+                    const qint64 size = qint64(reader.number());
+                    info.streamSizes.append(size);
+                    sum += size;
+                }
+                const qint64 last = info.folders.at(f).unpackSize() - sum;
+                if (last < 0)
+                    return false;
+                info.streamSizes.append(last);
+            }
+            if (haveSizes)
+                type = reader.number();
+
+            // A folder holding a single member lends it its own CRC; the rest are listed here
+            quint64 digestCount = 0;
+            for (int f = 0; f < info.folders.size(); ++f) {
+                const quint64 count = info.folderStreamCounts.at(f);
+                const bool inherited = count == 1 && info.folderHasCrc.value(f);
+                for (quint64 s = 0; s < count; ++s) {
+                    info.streamHasCrc.append(inherited);
+                    info.streamCrcs.append(inherited ? info.folderCrcs.at(f) : 0);
+                }
+                if (!inherited)
+                    digestCount += count;
+            }
+
+            for (; type != kEnd && reader.ok(); type = reader.number()) {
+                if (type != kCRC)
+                    return false;
+
+                const QVector<bool> defined = reader.optionalBits(digestCount);
+                int digest = 0;
+                int stream = 0;
+                for (int f = 0; f < info.folders.size(); ++f) {
+                    const quint64 count = info.folderStreamCounts.at(f);
+                    const bool inherited = count == 1 && info.folderHasCrc.value(f);
+                    for (quint64 s = 0; s < count; ++s, ++stream) {
+                        if (inherited)
+                            continue;
+                        if (defined.value(digest++)) {
+                            info.streamHasCrc[stream] = true;
+                            info.streamCrcs[stream] = reader.uint32();
+                        }
+                    }
+                }
+            }
+        } else {
+            return false;
+        }
+
+        if (!reader.ok())
+            return false;
+    }
+
+    // Locate each folder's packed data; folders consume pack streams in order
+    int packIndex = 0;
+    qint64 packOffset = SIGNATURE_HEADER_SIZE + qint64(info.packPos);
+    for (Folder& folder : info.folders) {
+        folder.packOffset = packOffset;
+        folder.packSize = qint64(info.packSizes.value(packIndex));
+        for (int p = 0; p < folder.packedStreams.size(); ++p)
+            packOffset += qint64(info.packSizes.value(packIndex++));
+    }
+
+    if (!haveSubStreams) {
+        // Without substreams info every folder holds exactly one member
+        info.folderStreamCounts = QVector<quint64>(info.folders.size(), 1);
+        for (int f = 0; f < info.folders.size(); ++f) {
+            info.streamSizes.append(info.folders.at(f).unpackSize());
+            info.streamHasCrc.append(info.folderHasCrc.value(f));
+            info.streamCrcs.append(info.folderCrcs.value(f));
+        }
+    }
+
+    return reader.ok();
+}
+
+bool SevenZipArchive::readFilesInfo(HeaderReader& reader, const StreamsInfo& info)
+{
+    const quint64 fileCount = reader.number();
+    if (!reader.plausibleCount(fileCount, MAX_FILES))
+        return false;
+
+    QVector<bool> emptyStream(static_cast<qint64>(fileCount), false);
+    QVector<bool> emptyFile;
+    QVector<QString> names(static_cast<qint64>(fileCount));
+
+    for (quint64 type = reader.number(); type != kEnd && reader.ok(); type = reader.number()) {
+        const quint64 size = reader.number();
+        if (size > quint64(reader.remaining()))
+            return false;
+        const qint64 end = reader.pos() + qint64(size);
+
+        if (type == kEmptyStream) {
+            emptyStream = reader.bits(fileCount);
+        } else if (type == kEmptyFile) {
+            emptyFile = reader.bits(quint64(std::count(emptyStream.cbegin(), emptyStream.cend(), true)));
+        } else if (type == kName) {
+            if (reader.byte() != 0) // External names are not used
+                return false;
+
+            // NUL-terminated UTF-16LE names, one per file
+            const QByteArray raw = reader.bytes(quint64(end - reader.pos()));
+            const char16_t* chars = reinterpret_cast<const char16_t*>(raw.constData());
+            const qint64 charCount = raw.size() / 2;
+            qint64 start = 0;
+            for (qint64 file = 0, i = 0; file < names.size() && i < charCount; ++i) {
+                if (qFromLittleEndian<quint16>(chars + i) == 0) {
+                    QString name;
+                    name.reserve(i - start);
+                    for (qint64 c = start; c < i; ++c)
+                        name.append(QChar(qFromLittleEndian<quint16>(chars + c)));
+                    names[file++] = name;
+                    start = i + 1;
+                }
+            }
+        }
+
+        reader.seek(end);
+    }
+
+    if (!reader.ok())
+        return false;
+
+    int folder = 0;
+    quint64 streamInFolder = 0;
+    qint64 folderOffset = 0;
+    int stream = 0;
+    int emptyIndex = 0;
+
+    for (quint64 i = 0; i < fileCount; ++i) {
+        Entry entry;
+        entry.name = names.at(qint64(i));
+
+        if (emptyStream.value(qint64(i))) {
+            // An empty stream that is not an empty file is a directory
+            const bool isFile = emptyFile.value(emptyIndex++);
+            if (!isFile)
+                continue;
+            m_entries.append(entry);
+            continue;
+        }
+
+        while (folder < info.folders.size() && streamInFolder >= info.folderStreamCounts.value(folder)) {
+            ++folder;
+            streamInFolder = 0;
+            folderOffset = 0;
+        }
+        if (folder >= info.folders.size() || stream >= info.streamSizes.size())
+            return false;
+
+        entry.folder = folder;
+        entry.folderOffset = folderOffset;
+        entry.size = info.streamSizes.at(stream);
+        entry.hasCrc = info.streamHasCrc.value(stream);
+        entry.crc32 = info.streamCrcs.value(stream);
+
+        folderOffset += entry.size;
+        ++streamInFolder;
+        ++stream;
+        m_entries.append(entry);
+    }
+
+    return true;
+}
+
+bool SevenZipArchive::decodeFolder(const Folder& folder, const FolderSink& sink)
+{
+    // Only plain coder chains are supported: each coder has one input and
+    // one output, and the single packed stream feeds the last one
+    if (folder.packedStreams.size() != 1)
+        return false;
+    for (const Coder& coder : folder.coders) {
+        if (coder.inStreams != 1 || coder.outStreams != 1)
+            return false;
+    }
+
+    // Walk from the folder's output towards its packed input; liblzma wants
+    // the filters in that (encoder) order
+    QVector<int> chain;
+    int current = -1;
+    for (int c = 0; c < folder.coders.size(); ++c) {
+        bool bound = false;
+        for (const auto& pair : folder.bindPairs)
+            bound = bound || pair.second == quint64(c);
+        if (!bound) {
+            current = c;
+            break;
+        }
+    }
+    while (current >= 0 && chain.size() <= folder.coders.size()) {
+        chain.append(current);
+        int next = -1;
+        for (const auto& pair : folder.bindPairs) {
+            if (pair.first == quint64(current))
+                next = int(pair.second);
+        }
+        current = next;
+    }
+    if (chain.size() != folder.coders.size() || quint64(chain.last()) != folder.packedStreams.first())
+        return false;
+
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    int filterCount = 0;
+    bool supported = true;
+    for (int c : chain) {
+        const Coder& coder = folder.coders.at(c);
+        lzma_filter filter;
+        filter.options = nullptr;
+
+        if (coder.id == QByteArray("\x00", 1)) {
+            continue; // Copy
+        } else if (coder.id == QByteArray("\x21", 1)) {
+            filter.id = LZMA_FILTER_LZMA2;
+        } else if (coder.id == QByteArray("\x03\x01\x01", 3)) {
+#if SEVENZIP_HAVE_LZMA1EXT
+            filter.id = LZMA_FILTER_LZMA1EXT; // Ends at a known size, like 7-Zip's streams (no end marker)
+#else
+            filter.id = LZMA_FILTER_LZMA1;
+#endif
+        } else if (coder.id == QByteArray("\x03\x03\x01\x03", 4)) {
+            filter.id = LZMA_FILTER_X86;
+        } else if (coder.id == QByteArray("\x03", 1)) {
+            filter.id = LZMA_FILTER_DELTA;
+        } else {
+            qWarning() << "Unsupported 7z coder" << coder.id.toHex();
+            supported = false;
+            break;
+        }
+
+        if (filterCount >= LZMA_FILTERS_MAX ||
+            lzma_properties_decode(&filter, nullptr,
+                                   reinterpret_cast<const uint8_t*>(coder.properties.constData()),
+                                   size_t(coder.properties.size())) != LZMA_OK) {
+            supported = false;
+            break;
+        }
+
+#if SEVENZIP_HAVE_LZMA1EXT
+        if (filter.id == LZMA_FILTER_LZMA1EXT) {
+            lzma_options_lzma* options = static_cast<lzma_options_lzma*>(filter.options);
+            const quint64 size = folder.unpackSizes.value(c);
+            options->ext_flags = LZMA_LZMA1EXT_ALLOW_EOPM;
+            options->ext_size_low = quint32(size);
+            options->ext_size_high = quint32(size >> 32);
+        }
+#endif
+        filters[filterCount++] = filter;
+    }
+    filters[filterCount].id = LZMA_VLI_UNKNOWN;
+
+    auto freeFilters = [&]() {
+        for (int i = 0; i < filterCount; ++i)
+            free(filters[i].options); // Allocated by lzma_properties_decode with the default allocator
+    };
+
+    if (!supported) {
+        freeFilters();
+        return false;
+    }
+
+    const qint64 unpackSize = folder.unpackSize();
+    if (!m_file.seek(folder.packOffset)) {
+        freeFilters();
+        return false;
+    }
+
+    qint64 remainingInput = folder.packSize;
+    qint64 produced = 0;
+
+    if (filterCount == 0) {
+        // Stored folder: the packed data is the unpacked data
+        QByteArray buffer(qMin(OUTPUT_BUFFER_SIZE, qMax<qint64>(unpackSize, 1)), Qt::Uninitialized);
+        while (produced < unpackSize) {
+            const qint64 length = qMin<qint64>(buffer.size(), unpackSize - produced);
+            if (m_file.read(buffer.data(), length) != length)
+                return false;
+            produced += length;
+            if (!sink(buffer.constData(), length))
+                return false;
+        }
+        return true;
+    }
+
+    lzma_stream stream = LZMA_STREAM_INIT;
+    if (lzma_raw_decoder(&stream, filters) != LZMA_OK) {
+        freeFilters();
+        return false;
+    }
+
+    QByteArray input(qMin(INPUT_BUFFER_SIZE, qMax<qint64>(remainingInput, 1)), Qt::Uninitialized);
+    QByteArray output(qMin(OUTPUT_BUFFER_SIZE, qMax<qint64>(unpackSize, 1)), Qt::Uninitialized);
+    stream.next_out = reinterpret_cast<uint8_t*>(output.data());
+    stream.avail_out = size_t(output.size());
+
+    bool ok = true;
+    while (produced < unpackSize) {
+        if (stream.avail_in == 0 && remainingInput > 0) {
+            const qint64 length = qMin<qint64>(input.size(), remainingInput);
+            if (m_file.read(input.data(), length) != length) {
+                ok = false;
+                break;
+            }
+            remainingInput -= length;
+            stream.next_in = reinterpret_cast<const uint8_t*>(input.constData());
+            stream.avail_in = size_t(length);
+        }
+
+        const lzma_action action = (remainingInput == 0 && stream.avail_in == 0) ? LZMA_FINISH : LZMA_RUN;
+        const lzma_ret result = lzma_code(&stream, action);
+
+        const qint64 length = qMin<qint64>(output.size() - qint64(stream.avail_out), unpackSize - produced);
+        const bool ended = result == LZMA_STREAM_END || produced + length >= unpackSize;
+        if (length > 0 && (stream.avail_out == 0 || ended)) {
+            produced += length;
+            if (!sink(output.constData(), length)) {
+                ok = false;
+                break;
+            }
+            stream.next_out = reinterpret_cast<uint8_t*>(output.data());
+            stream.avail_out = size_t(output.size());
+        }
+
+        if (ended)
+            break;
+        if (result != LZMA_OK) {
+            qWarning() << "7z folder failed to decode, liblzma error" << result;
+            ok = false;
+            break;
+        }
+    }
+
+    lzma_end(&stream);
+    freeFilters();
+    return ok && produced == unpackSize;
+}
+
+QByteArray SevenZipArchive::read(const Entry& entry, qint64 maxSize)
+{
+    const qint64 size = maxSize < 0 ? entry.size : qMin(maxSize, entry.size);
+    if (size <= 0)
+        return QByteArray();
+
+    QByteArray data;
+    data.reserve(size);
+    stream(entry, qMin(size, OUTPUT_BUFFER_SIZE), [&](char* chunk, qint64 length) {
+        data.append(chunk, qMin(length, size - data.size()));
+        return data.size() < size;
+    });
+
+    // Errors were reported by stream(); stopping early after size bytes is not one
+    if (data.size() < size)
+        return QByteArray();
+    return data;
+}
+
+QVector<QByteArray> SevenZipArchive::readHeads(const QVector<Entry>& entries, qint64 maxSize)
+{
+    QVector<QByteArray> heads(entries.size());
+
+    // One decoding pass per folder, stopping after the last head it holds
+    for (int f = 0; f < m_folders.size(); ++f) {
+        qint64 end = 0;
+        for (const Entry& entry : entries) {
+            if (entry.folder == f)
+                end = qMax(end, entry.folderOffset + qMin(maxSize, entry.size));
+        }
+        if (end == 0)
+            continue;
+
+        qint64 position = 0;
+        decodeFolder(m_folders.at(f), [&](const char* data, qint64 size) {
+            for (int i = 0; i < entries.size(); ++i) {
+                const Entry& entry = entries.at(i);
+                if (entry.folder != f)
+                    continue;
+
+                // Copy the part of this chunk that falls inside the member's head
+                const qint64 headEnd = entry.folderOffset + qMin(maxSize, entry.size);
+                const qint64 from = qMax(entry.folderOffset + heads.at(i).size(), position);
+                const qint64 to = qMin(headEnd, position + size);
+                if (from < to)
+                    heads[i].append(data + (from - position), to - from);
+            }
+            position += size;
+            return position < end;
+        });
+    }
+
+    // Drop heads that came out short because their folder failed to decode
+    for (int i = 0; i < entries.size(); ++i) {
+        if (heads.at(i).size() != qMin(maxSize, entries.at(i).size))
+            heads[i].clear();
+    }
+    return heads;
+}
+
+bool SevenZipArchive::stream(const Entry& entry, qint64 chunkSize, const ChunkHandler& handler)
+{
+    if (entry.folder < 0 || entry.folder >= m_folders.size())
+        return entry.size == 0; // Empty members have no data to stream
+
+    // Re-chunk folder output into exactly chunkSize pieces of this member
+    QByteArray buffer(chunkSize, Qt::Uninitialized);
+    qint64 filled = 0;
+    qint64 skip = entry.folderOffset;
+    qint64 remaining = entry.size;
+    quint32 crc = 0;
+    bool stopped = false;
+
+    decodeFolder(m_folders.at(entry.folder), [&](const char* data, qint64 size) {
+        if (skip >= size) {
+            skip -= size;
+            return true;
+        }
+        data += skip;
+        size = qMin(size - skip, remaining);
+        skip = 0;
+
+        while (size > 0) {
+            const qint64 length = qMin(size, chunkSize - filled);
+            memcpy(buffer.data() + filled, data, size_t(length));
+            filled += length;
+            data += length;
+            size -= length;
+            remaining -= length;
+
+            if (filled == chunkSize) {
+                crc = RomParser::updateCrc32(crc, buffer.constData(), filled);
+                if (!handler(buffer.data(), filled)) {
+                    stopped = true;
+                    return false;
+                }
+                filled = 0;
+            }
+        }
+        return remaining > 0;
+    });
+
+    if (stopped)
+        return false;
+    if (remaining > 0) {
+        qWarning() << "Failed to decode 7z member" << entry.name;
+        return false;
+    }
+
+    if (filled > 0) {
+        crc = RomParser::updateCrc32(crc, buffer.constData(), filled);
+        if (!handler(buffer.data(), filled))
+            return false;
+    }
+
+    if (entry.hasCrc && crc != entry.crc32) {
+        qWarning() << "7z member failed its CRC check:" << entry.name;
+        return false;
+    }
+    return true;
+}
+
+} // namespace QT_UI
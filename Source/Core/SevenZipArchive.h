@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QPair>
+#include <functional>
+
+namespace QT_UI {
+
+/**
+ * @brief Read-only streaming access to the members of a 7z archive
+ *
+ * Parses the archive header (decoding it first if it is compressed) and
+ * decodes folders with liblzma on demand. Supports the coders 7-Zip uses for
+ * ROM sets: LZMA, LZMA2, Copy and the BCJ (x86) and Delta filters; members
+ * in folders using anything else (BCJ2, PPMd, encryption) cannot be read.
+ *
+ * In a solid archive many members share one folder, which can only be
+ * decoded from its start, so reading a member means decoding every member
+ * packed before it. readHeads() collects the start of several members with a
+ * single pass per folder.
+ *
+ * Not thread-safe; each worker opens its own archive.
+ */
+class SevenZipArchive {
+public:
+    struct Entry {
+        QString name;
+        qint64 size = 0;
+        quint32 crc32 = 0;
+        bool hasCrc = false;
+        int folder = -1;         // -1 for empty members, which have no data
+        qint64 folderOffset = 0; // Offset of the member in its folder's unpacked data
+    };
+
+    // Receives each decoded chunk, which it may modify in place; return false to stop early
+    using ChunkHandler = std::function<bool(char* data, qint64 size)>;
+
+    SevenZipArchive();
+    ~SevenZipArchive();
+
+    /**
+     * @brief Opens an archive and reads its header
+     * @return False if the file is not a readable 7z archive
+     */
+    bool open(const QString& filePath);
+    void close();
+
+    const QVector<Entry>& entries() const;
+
+    /**
+     * @brief Gets the members whose names carry a ROM extension, in archive order
+     */
+    QVector<Entry> romEntries() const;
+
+    /**
+     * @brief Decodes the first maxSize bytes of a member (all of it if maxSize < 0)
+     */
+    QByteArray read(const Entry& entry, qint64 maxSize = -1);
+
+    /**
+     * @brief Decodes the first maxSize bytes of several members, one pass per folder
+     * @return The heads in the order of the given entries; empty where decoding failed
+     */
+    QVector<QByteArray> readHeads(const QVector<Entry>& entries, qint64 maxSize);
+
+    /**
+     * @brief Decodes a member front to back in chunks
+     *
+     * Every chunk except the last is exactly chunkSize bytes. When the whole
+     * member was streamed its CRC-32 is checked against the header.
+     * @return False on a read or decode error, or if the handler stopped early
+     */
+    bool stream(const Entry& entry, qint64 chunkSize, const ChunkHandler& handler);
+
+private:
+    struct Coder {
+        QByteArray id;
+        QByteArray properties;
+        quint64 inStreams = 1;
+        quint64 outStreams = 1;
+    };
+
+    struct Folder {
+        QVector<Coder> coders;
+        QVector<QPair<quint64, quint64>> bindPairs; // (in stream, out stream)
+        QVector<quint64> packedStreams;
+        QVector<quint64> unpackSizes;               // One per coder out stream
+        qint64 packOffset = 0;                      // Absolute file offset of its packed data
+        qint64 packSize = 0;
+        qint64 unpackSize() const;
+    };
+
+    struct StreamsInfo;
+    class HeaderReader;
+
+    // Receives decoded folder data in order; return false to stop
+    using FolderSink = std::function<bool(const char* data, qint64 size)>;
+
+    bool readHeader(HeaderReader& reader);
+    bool readStreamsInfo(HeaderReader& reader, StreamsInfo& info);
+    bool readFilesInfo(HeaderReader& reader, const StreamsInfo& info);
+    bool decodeFolder(const Folder& folder, const FolderSink& sink);
+
+    QFile m_file;
+    QVector<Entry> m_entries;
+    QVector<Folder> m_folders;
+};
+
+} // namespace QT_UI
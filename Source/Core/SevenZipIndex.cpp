@@ -0,0 +1,201 @@
+#include "SevenZipIndex.h"
+#include "RomParser.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace QT_UI {
+
+// Bump INDEX_VERSION whenever the record layout or the head size changes
+static const quint32 INDEX_MAGIC = 0x5036345A; // "P64Z"
+static const quint32 INDEX_VERSION = 1;
+
+static QDataStream& operator<<(QDataStream& out, const SevenZipIndex::Member& member)
+{
+    const SevenZipArchive::Entry& entry = member.entry;
+    return out << entry.name << entry.size << entry.crc32 << entry.hasCrc
+               << qint32(entry.folder) << entry.folderOffset << member.head;
+}
+
+static QDataStream& operator>>(QDataStream& in, SevenZipIndex::Member& member)
+{
+    SevenZipArchive::Entry& entry = member.entry;
+    qint32 folder = -1;
+    in >> entry.name >> entry.size >> entry.crc32 >> entry.hasCrc >> folder >> entry.folderOffset >> member.head;
+    entry.folder = folder;
+    return in;
+}
+
+SevenZipIndex::SevenZipIndex(const QString& indexFilePath)
+    : m_indexFilePath(indexFilePath)
+    , m_loaded(false)
+    , m_dirty(false)
+{
+}
+
+SevenZipIndex& SevenZipIndex::instance()
+{
+    static SevenZipIndex index;
+    return index;
+}
+
+QString SevenZipIndex::defaultIndexPath()
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QCoreApplication::applicationDirPath();
+    }
+    return QDir(cacheDir).filePath("sevenzip.index");
+}
+
+void SevenZipIndex::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(m_indexFilePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION || in.status() != QDataStream::Ok) {
+        qDebug() << "Ignoring incompatible 7z index:" << m_indexFilePath;
+        return;
+    }
+
+    m_archives.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Archive archive;
+        in >> path >> archive.size >> archive.modified >> archive.members;
+        m_archives.insert(path, archive);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "7z index is truncated or corrupt, discarding:" << m_indexFilePath;
+        m_archives.clear();
+        m_dirty = true;
+    }
+}
+
+bool SevenZipIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_dirty)
+        return true;
+
+    QDir().mkpath(QFileInfo(m_indexFilePath).absolutePath());
+
+    QSaveFile file(m_indexFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write 7z index:" << m_indexFilePath;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << INDEX_MAGIC << INDEX_VERSION << quint32(m_archives.size());
+
+    for (auto it = m_archives.cbegin(); it != m_archives.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->members;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "Failed to commit 7z index:" << m_indexFilePath;
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+bool SevenZipIndex::romMembers(const QString& archivePath, QVector<Member>& members)
+{
+    QFileInfo fileInfo(archivePath);
+    if (!fileInfo.exists())
+        return false;
+
+    const qint64 size = fileInfo.size();
+    const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+
+        auto it = m_archives.constFind(archivePath);
+        if (it != m_archives.cend() && it->size == size && it->modified == modified) {
+            members = it->members;
+            return true;
+        }
+    }
+
+    // Decode outside the lock; two workers indexing the same archive at once
+    // merely do the work twice
+    SevenZipArchive archive;
+    if (!archive.open(archivePath)) {
+        // Drop the entry of an archive that no longer reads
+        QMutexLocker locker(&m_mutex);
+        if (m_archives.remove(archivePath) > 0) {
+            m_dirty = true;
+        }
+        return false;
+    }
+
+    const QVector<SevenZipArchive::Entry> roms = archive.romEntries();
+    const QVector<QByteArray> heads = archive.readHeads(roms, RomParser::BOOT_AREA_SIZE);
+
+    Archive indexed;
+    indexed.size = size;
+    indexed.modified = modified;
+    for (int i = 0; i < roms.size(); ++i) {
+        Member member;
+        member.entry = roms.at(i);
+        member.head = heads.at(i);
+        indexed.members.append(member);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_archives.insert(archivePath, indexed);
+    m_dirty = true;
+
+    members = indexed.members;
+    return true;
+}
+
+void SevenZipIndex::prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    // Paths are keyed exactly as the scanner's QDirIterator reports them
+    QString prefix = QDir::cleanPath(directory) + '/';
+
+    for (auto it = m_archives.begin(); it != m_archives.end();) {
+        const QString& path = it.key();
+        bool inScope = path.startsWith(prefix) &&
+                       (recursive || path.indexOf('/', prefix.size()) < 0);
+        if (inScope && !seenPaths.contains(path)) {
+            it = m_archives.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace QT_UI
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "SevenZipArchive.h"
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+
+namespace QT_UI {
+
+/**
+ * @brief Persistent index of the ROM members of 7z archives
+ *
+ * A member of a solid archive can only be reached by decoding every member
+ * packed before it, so reading the headers of a large ROM set costs as much
+ * as extracting it. The index records, per archive, where each ROM member
+ * sits in its folder and the first bytes of it (the boot area), so re-scans
+ * of an unchanged archive decode nothing. Entries are keyed by archive path
+ * and validated by file size and modification time.
+ *
+ * All methods are thread-safe; scan workers build entries concurrently.
+ */
+class SevenZipIndex
+{
+public:
+    struct Member {
+        SevenZipArchive::Entry entry;
+        QByteArray head; // Raw (unconverted) first RomParser::BOOT_AREA_SIZE bytes; empty if undecodable
+    };
+
+    explicit SevenZipIndex(const QString& indexFilePath = defaultIndexPath());
+
+    /**
+     * @brief Gets the process-wide index, stored in the cache directory
+     */
+    static SevenZipIndex& instance();
+
+    /**
+     * @brief Gets the ROM members of an archive, indexing it first if needed
+     * @return False if the archive could not be read
+     */
+    bool romMembers(const QString& archivePath, QVector<Member>& members);
+
+    /**
+     * @brief Removes archives below a directory that were not seen by a completed scan
+     * @param directory Scanned directory
+     * @param recursive Whether the scan included subdirectories
+     * @param seenPaths Files found by the scan
+     */
+    void prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths);
+
+    /**
+     * @brief Writes the index to disk if it changed since the last load/save
+     * @return True on success or if nothing needed saving
+     */
+    bool save();
+
+    static QString defaultIndexPath();
+
+private:
+    struct Archive {
+        qint64 size = -1;
+        qint64 modified = 0; // ms since epoch
+        QVector<Member> members;
+    };
+
+    // Expects m_mutex to be held
+    void load();
+
+    QString m_indexFilePath;
+    QMutex m_mutex;
+    QHash<QString, Archive> m_archives;
+    bool m_loaded;
+    bool m_dirty;
+};
+
+} // namespace QT_UI
@@ -0,0 +1,61 @@
+#include "StringPool.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace QT_UI {
+
+StringPool::StringPool()
+    : m_count(0)
+{
+    for (std::atomic<QString*>& chunk : m_chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Id 0 is reserved for the empty string, so a zero-initialized id is valid
+    intern(QString());
+}
+
+StringPool::~StringPool()
+{
+    for (std::atomic<QString*>& chunk : m_chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+StringPool& StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+quint32 StringPool::intern(const QString& value)
+{
+    // Null and empty strings are the same value
+    const QString& key = value.isEmpty() ? QString() : value;
+
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_ids.constFind(key);
+    if (it != m_ids.cend())
+        return it.value();
+
+    const quint32 id = m_count;
+    const int chunkIndex = static_cast<int>(id >> CHUNK_BITS);
+    if (chunkIndex >= MAX_CHUNKS) {
+        qWarning() << "String pool is full, not interning:" << value;
+        return 0;
+    }
+
+    QString* chunk = m_chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new QString[CHUNK_SIZE];
+        m_chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+
+    chunk[id & (CHUNK_SIZE - 1)] = key;
+    m_ids.insert(key, id);
+    ++m_count;
+    return id;
+}
+
+} // namespace QT_UI
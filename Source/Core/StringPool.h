@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+
+namespace QT_UI {
+
+/**
+ * @brief Process-wide intern table for repeated metadata strings
+ *
+ * Genre, developer, country, media type, status and release date take a few
+ * hundred distinct values across a library of thousands of ROMs. Resolving
+ * them through the pool makes equal values share one allocation, and gives
+ * each distinct value a small id: two values are equal exactly when their ids
+ * (or their data pointers) are, so grouping and equality filters never
+ * compare characters.
+ *
+ * intern() is thread-safe (scan workers resolve database values through it).
+ * at() takes no lock: values are never moved or removed, so an id handed over
+ * from another thread, e.g. inside a queued scan result, stays readable.
+ */
+class StringPool
+{
+public:
+    static StringPool& instance();
+
+    /**
+     * @brief Gets the id of a value, adding it on first use; the empty string is 0
+     */
+    quint32 intern(const QString& value);
+
+    /**
+     * @brief Gets the pooled value for an id returned by intern()
+     */
+    const QString& at(quint32 id) const
+    {
+        return m_chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+
+    /**
+     * @brief Gets the pooled copy of a value, sharing its allocation
+     */
+    QString shared(const QString& value) { return at(intern(value)); }
+
+private:
+    StringPool();
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Values live in fixed-size chunks that are never reallocated
+    static const int CHUNK_BITS = 10;
+    static const quint32 CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const int MAX_CHUNKS = 1024;
+
+    QMutex m_mutex;
+    QHash<QString, quint32> m_ids;
+    quint32 m_count;
+    std::atomic<QString*> m_chunks[MAX_CHUNKS];
+};
+
+} // namespace QT_UI
@@ -0,0 +1,335 @@
+#include "ZipArchive.h"
+#include <QtEndian>
+#include <QDebug>
+#include <zlib.h>
+
+namespace QT_UI {
+
+// Record signatures and fixed sizes from the PKWARE APPNOTE
+static const quint32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const quint32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const quint32 END_OF_DIRECTORY_SIGNATURE = 0x06054b50;
+static const quint32 ZIP64_END_OF_DIRECTORY_SIGNATURE = 0x06064b50;
+static const quint32 ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+static const qint64 LOCAL_HEADER_SIZE = 30;
+static const qint64 CENTRAL_HEADER_SIZE = 46;
+static const qint64 END_OF_DIRECTORY_SIZE = 22;
+static const qint64 ZIP64_END_OF_DIRECTORY_SIZE = 56;
+static const qint64 ZIP64_LOCATOR_SIZE = 20;
+static const qint64 MAX_COMMENT_SIZE = 0xFFFF;
+
+static const quint16 METHOD_STORED = 0;
+static const quint16 METHOD_DEFLATED = 8;
+static const quint16 FLAG_ENCRYPTED = 0x0001;
+static const quint16 FLAG_UTF8 = 0x0800;
+
+// Compressed bytes read from the archive per step
+static const qint64 INPUT_BUFFER_SIZE = 64 * 1024;
+
+// Largest chunk read() inflates at once when asked for a whole member
+static const qint64 READ_CHUNK_SIZE = 1024 * 1024;
+
+static inline quint16 le16(const char* p) { return qFromLittleEndian<quint16>(p); }
+static inline quint32 le32(const char* p) { return qFromLittleEndian<quint32>(p); }
+static inline quint64 le64(const char* p) { return qFromLittleEndian<quint64>(p); }
+
+ZipArchive::ZipArchive()
+{
+}
+
+ZipArchive::~ZipArchive()
+{
+    close();
+}
+
+bool ZipArchive::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open ZIP archive:" << filePath;
+        return false;
+    }
+
+    if (!readCentralDirectory()) {
+        qWarning() << "Not a readable ZIP archive:" << filePath;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ZipArchive::close()
+{
+    m_file.close();
+    m_entries.clear();
+}
+
+const QVector<ZipArchive::Entry>& ZipArchive::entries() const
+{
+    return m_entries;
+}
+
+QVector<ZipArchive::Entry> ZipArchive::romEntries() const
+{
+    QVector<Entry> roms;
+    for (const Entry& entry : m_entries) {
+        if (isRomFileName(entry.name))
+            roms.append(entry);
+    }
+    return roms;
+}
+
+bool ZipArchive::isRomFileName(const QString& fileName)
+{
+    return fileName.endsWith(".z64", Qt::CaseInsensitive) ||
+           fileName.endsWith(".v64", Qt::CaseInsensitive) ||
+           fileName.endsWith(".n64", Qt::CaseInsensitive);
+}
+
+bool ZipArchive::readCentralDirectory()
+{
+    const qint64 fileSize = m_file.size();
+    if (fileSize < END_OF_DIRECTORY_SIZE)
+        return false;
+
+    // The end of directory record is followed only by the archive comment
+    const qint64 tailSize = qMin(fileSize, END_OF_DIRECTORY_SIZE + MAX_COMMENT_SIZE);
+    if (!m_file.seek(fileSize - tailSize))
+        return false;
+    const QByteArray tail = m_file.read(tailSize);
+    if (tail.size() != tailSize)
+        return false;
+
+    qint64 eocd = -1;
+    for (qint64 i = tailSize - END_OF_DIRECTORY_SIZE; i >= 0; --i) {
+        if (le32(tail.constData() + i) == END_OF_DIRECTORY_SIGNATURE) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd < 0)
+        return false;
+
+    const char* record = tail.constData() + eocd;
+    quint64 count = le16(record + 10);
+    quint64 directorySize = le32(record + 12);
+    quint64 directoryOffset = le32(record + 16);
+
+    // Saturated fields mean the real values are in the ZIP64 record, found
+    // through the locator right before the classic one
+    if (count == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) {
+        if (eocd < ZIP64_LOCATOR_SIZE || le32(record - ZIP64_LOCATOR_SIZE) != ZIP64_LOCATOR_SIGNATURE)
+            return false;
+
+        const qint64 zip64Offset = static_cast<qint64>(le64(record - ZIP64_LOCATOR_SIZE + 8));
+        if (!m_file.seek(zip64Offset))
+            return false;
+        const QByteArray zip64 = m_file.read(ZIP64_END_OF_DIRECTORY_SIZE);
+        if (zip64.size() != ZIP64_END_OF_DIRECTORY_SIZE || le32(zip64.constData()) != ZIP64_END_OF_DIRECTORY_SIGNATURE)
+            return false;
+
+        count = le64(zip64.constData() + 32);
+        directorySize = le64(zip64.constData() + 40);
+        directoryOffset = le64(zip64.constData() + 48);
+    }
+
+    if (directoryOffset + directorySize > quint64(fileSize) || !m_file.seek(qint64(directoryOffset)))
+        return false;
+    const QByteArray directory = m_file.read(qint64(directorySize));
+    if (directory.size() != qint64(directorySize))
+        return false;
+
+    const char* data = directory.constData();
+    const qint64 size = directory.size();
+    qint64 pos = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        if (pos + CENTRAL_HEADER_SIZE > size || le32(data + pos) != CENTRAL_HEADER_SIGNATURE)
+            return false;
+
+        const char* header = data + pos;
+        const quint16 flags = le16(header + 8);
+        const quint16 nameLength = le16(header + 28);
+        const quint16 extraLength = le16(header + 30);
+        const quint16 commentLength = le16(header + 32);
+        if (pos + CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength > size)
+            return false;
+
+        Entry entry;
+        entry.method = le16(header + 10);
+        entry.crc32 = le32(header + 16);
+        quint64 compressedSize = le32(header + 20);
+        quint64 uncompressedSize = le32(header + 24);
+        quint64 localHeaderOffset = le32(header + 42);
+
+        const char* name = header + CENTRAL_HEADER_SIZE;
+        entry.name = (flags & FLAG_UTF8) ? QString::fromUtf8(name, nameLength)
+                                         : QString::fromLatin1(name, nameLength);
+
+        // The ZIP64 extra field holds 64-bit values for exactly the saturated fields, in this order
+        const char* extra = name + nameLength;
+        const char* extraEnd = extra + extraLength;
+        while (extra + 4 <= extraEnd) {
+            const quint16 id = le16(extra);
+            const quint16 fieldSize = le16(extra + 2);
+            const char* field = extra + 4;
+            const char* fieldEnd = qMin(field + fieldSize, extraEnd);
+            if (id == 0x0001) {
+                if (uncompressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                    uncompressedSize = le64(field);
+                    field += 8;
+                }
+                if (compressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                    compressedSize = le64(field);
+                    field += 8;
+                }
+                if (localHeaderOffset == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                    localHeaderOffset = le64(field);
+                }
+            }
+            extra += 4 + fieldSize;
+        }
+
+        pos += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+
+        // Directories and encrypted members can never be a readable ROM
+        if (entry.name.endsWith('/') || (flags & FLAG_ENCRYPTED))
+            continue;
+
+        entry.compressedSize = qint64(compressedSize);
+        entry.uncompressedSize = qint64(uncompressedSize);
+        entry.localHeaderOffset = qint64(localHeaderOffset);
+        m_entries.append(entry);
+    }
+
+    return true;
+}
+
+qint64 ZipArchive::dataOffset(const Entry& entry)
+{
+    // The local header repeats the name and may carry a different extra field
+    if (!m_file.seek(entry.localHeaderOffset))
+        return -1;
+
+    const QByteArray header = m_file.read(LOCAL_HEADER_SIZE);
+    if (header.size() != LOCAL_HEADER_SIZE || le32(header.constData()) != LOCAL_HEADER_SIGNATURE)
+        return -1;
+
+    return entry.localHeaderOffset + LOCAL_HEADER_SIZE +
+           le16(header.constData() + 26) + le16(header.constData() + 28);
+}
+
+QByteArray ZipArchive::read(const Entry& entry, qint64 maxSize)
+{
+    const qint64 size = maxSize < 0 ? entry.uncompressedSize : qMin(maxSize, entry.uncompressedSize);
+    if (size <= 0)
+        return QByteArray();
+
+    QByteArray data;
+    data.reserve(size);
+    stream(entry, qMin(size, READ_CHUNK_SIZE), [&](char* chunk, qint64 length) {
+        data.append(chunk, qMin(length, size - data.size()));
+        return data.size() < size;
+    });
+
+    // Errors were reported by stream(); stopping early after size bytes is not one
+    if (data.size() < size)
+        return QByteArray();
+    return data;
+}
+
+bool ZipArchive::stream(const Entry& entry, qint64 chunkSize, const ChunkHandler& handler)
+{
+    if (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED) {
+        qWarning() << "Unsupported ZIP compression method" << entry.method << "for" << entry.name;
+        return false;
+    }
+
+    const qint64 offset = dataOffset(entry);
+    if (offset < 0 || !m_file.seek(offset)) {
+        qWarning() << "Corrupt ZIP local header for" << entry.name;
+        return false;
+    }
+
+    QByteArray output(chunkSize, Qt::Uninitialized);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    qint64 remainingInput = entry.compressedSize;
+    qint64 produced = 0;
+
+    if (entry.method == METHOD_STORED) {
+        while (remainingInput > 0) {
+            const qint64 length = qMin(chunkSize, remainingInput);
+            if (m_file.read(output.data(), length) != length) {
+                qWarning() << "Failed to read ZIP member" << entry.name;
+                return false;
+            }
+            remainingInput -= length;
+            produced += length;
+            crc = crc32(crc, reinterpret_cast<const Bytef*>(output.constData()), uInt(length));
+            if (!handler(output.data(), length))
+                return false;
+        }
+    } else {
+        z_stream zs {};
+        if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) // Raw deflate, no zlib header
+            return false;
+
+        QByteArray input(qMin(INPUT_BUFFER_SIZE, qMax<qint64>(remainingInput, 1)), Qt::Uninitialized);
+        bool ok = true;
+        bool finished = false;
+        while (ok && !finished) {
+            // Fill the output buffer completely, so chunks stay word aligned for byte order conversion
+            zs.next_out = reinterpret_cast<Bytef*>(output.data());
+            zs.avail_out = uInt(chunkSize);
+            while (zs.avail_out > 0) {
+                if (zs.avail_in == 0) {
+                    const qint64 length = qMin<qint64>(input.size(), remainingInput);
+                    if (length <= 0 || m_file.read(input.data(), length) != length) {
+                        ok = false; // Truncated member
+                        break;
+                    }
+                    remainingInput -= length;
+                    zs.next_in = reinterpret_cast<Bytef*>(input.data());
+                    zs.avail_in = uInt(length);
+                }
+
+                const int result = inflate(&zs, Z_NO_FLUSH);
+                if (result == Z_STREAM_END) {
+                    finished = true;
+                    break;
+                }
+                if (result != Z_OK) {
+                    ok = false;
+                    break;
+                }
+            }
+
+            const qint64 length = chunkSize - zs.avail_out;
+            if (ok && length > 0) {
+                produced += length;
+                crc = crc32(crc, reinterpret_cast<const Bytef*>(output.constData()), uInt(length));
+                if (!handler(output.data(), length)) {
+                    inflateEnd(&zs);
+                    return false;
+                }
+            }
+        }
+
+        inflateEnd(&zs);
+        if (!ok) {
+            qWarning() << "Failed to inflate ZIP member" << entry.name;
+            return false;
+        }
+    }
+
+    if (produced != entry.uncompressedSize || quint32(crc) != entry.crc32) {
+        qWarning() << "ZIP member failed its CRC check:" << entry.name;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace QT_UI
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <functional>
+
+namespace QT_UI {
+
+/**
+ * @brief Read-only streaming access to the members of a ZIP archive
+ *
+ * Only the central directory is read on open. Members are inflated on
+ * demand in fixed-size chunks, straight from the archive file, so reading a
+ * ROM header costs a few KB of inflation and nothing is ever extracted to
+ * disk. Supports stored and deflated members, including ZIP64 archives;
+ * encrypted members are skipped.
+ *
+ * Not thread-safe; each worker opens its own archive.
+ */
+class ZipArchive {
+public:
+    struct Entry {
+        QString name;
+        quint16 method = 0;
+        quint32 crc32 = 0;
+        qint64 compressedSize = 0;
+        qint64 uncompressedSize = 0;
+        qint64 localHeaderOffset = 0;
+    };
+
+    // Receives each inflated chunk, which it may modify in place; return false to stop early
+    using ChunkHandler = std::function<bool(char* data, qint64 size)>;
+
+    ZipArchive();
+    ~ZipArchive();
+
+    /**
+     * @brief Opens an archive and reads its central directory
+     * @return False if the file is not a readable ZIP archive
+     */
+    bool open(const QString& filePath);
+    void close();
+
+    const QVector<Entry>& entries() const;
+
+    /**
+     * @brief Gets the members whose names carry a ROM extension, in archive order
+     */
+    QVector<Entry> romEntries() const;
+
+    /**
+     * @brief Inflates the first maxSize bytes of a member (all of it if maxSize < 0)
+     */
+    QByteArray read(const Entry& entry, qint64 maxSize = -1);
+
+    /**
+     * @brief Inflates a member front to back in chunks
+     *
+     * Every chunk except the last is exactly chunkSize bytes. When the whole
+     * member was streamed its CRC-32 is checked against the directory.
+     * @return False on a read or inflate error, or if the handler stopped early
+     */
+    bool stream(const Entry& entry, qint64 chunkSize, const ChunkHandler& handler);
+
+    static bool isRomFileName(const QString& fileName);
+
+private:
+    bool readCentralDirectory();
+    qint64 dataOffset(const Entry& entry);
+
+    QFile m_file;
+    QVector<Entry> m_entries;
+};
+
+} // namespace QT_UI
@@ -34,10 +34,8 @@ RomBrowserWidget::RomBrowserWidget(QWidget* parent)
 {
     // Create models
     m_romListModel = new RomListModel(this);
-    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel = new RomSortFilterProxy(this);
     m_proxyModel->setSourceModel(m_romListModel);
-    m_proxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
-    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     
     // Create UI components
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
@@ -60,8 +58,12 @@ RomBrowserWidget::RomBrowserWidget(QWidget* parent)
     m_progressBar->setTextVisible(true);
     m_progressBar->setMinimum(0);
     
+    m_cancelScanButton = new QPushButton(tr("Cancel"), this);
+    m_cancelScanButton->setVisible(false);
+    
     statusLayout->addWidget(m_statusLabel, 1);
     statusLayout->addWidget(m_progressBar);
+    statusLayout->addWidget(m_cancelScanButton);
     
     mainLayout->addLayout(statusLayout);
     
@@ -196,7 +198,7 @@ void RomBrowserWidget::onZoomValueChanged(int value)
 
 void RomBrowserWidget::onFilterTextChanged(const QString& text)
 {
-    m_proxyModel->setFilterFixedString(text);
+    m_proxyModel->setSearchText(text);
 }
 
 void RomBrowserWidget::onSortIndicatorChanged(int column, Qt::SortOrder order)
@@ -296,6 +298,7 @@ void RomBrowserWidget::onScanStarted()
 {
     m_progressBar->setValue(0);
     m_progressBar->setVisible(true);
+    m_cancelScanButton->setVisible(true);
     m_statusLabel->setText(tr("Scanning for ROMs..."));
 }
 
@@ -309,6 +312,7 @@ void RomBrowserWidget::onScanProgress(int current, int total)
 void RomBrowserWidget::onScanFinished()
 {
     m_progressBar->setVisible(false);
+    m_cancelScanButton->setVisible(false);
     int count = m_romListModel->rowCount();
     m_statusLabel->setText(tr("Found %n ROM(s)", "", count));
     
@@ -540,6 +544,14 @@ void RomBrowserWidget::createConnections()
     connect(m_romListModel, &RomListModel::scanStarted, this, &RomBrowserWidget::onScanStarted);
     connect(m_romListModel, &RomListModel::scanProgress, this, &RomBrowserWidget::onScanProgress);
     connect(m_romListModel, &RomListModel::scanFinished, this, &RomBrowserWidget::onScanFinished);
+    connect(m_cancelScanButton, &QPushButton::clicked, m_romListModel, &RomListModel::cancelScan);
+    
+    // Scans are asynchronous, so leave the empty state as soon as the first ROM shows up
+    connect(m_romListModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (m_viewStack->currentWidget() == m_emptyStateWidget) {
+            updateEmptyStateVisibility();
+        }
+    });
     
     // Layout changes
     connect(this, &RomBrowserWidget::layoutChange, this, [this]() {
@@ -7,7 +7,6 @@
 #include <QToolBar>
 #include <QLineEdit>
 #include <QComboBox>
-#include <QSortFilterProxyModel>
 #include <QFileSystemModel>
 #include <QLabel>
 #include <QProgressBar>
@@ -17,6 +16,7 @@
 #include <QToolButton>
 
 #include "RomListModel.h"
+#include "RomSortFilterProxy.h"
 
 namespace QT_UI {
 
@@ -86,13 +86,13 @@ public:
 signals:
     /**
      * @brief Emitted when a ROM is selected
-     * @param romPath Path to the selected ROM
+     * @param romPath Path to the selected ROM (RomInfo::key(), so it names the member for archives)
      */
     void romSelected(const QString& romPath);
     
     /**
      * @brief Emitted when a ROM is double-clicked (should trigger loading)
-     * @param romPath Path to the double-clicked ROM
+     * @param romPath Path to the double-clicked ROM (RomInfo::key())
      */
     void romDoubleClicked(const QString& romPath);
     
@@ -151,6 +151,7 @@ private:
     QLineEdit* m_searchBox;
     QLabel* m_statusLabel;
     QProgressBar* m_progressBar;
+    QPushButton* m_cancelScanButton;
     
     // Toolbar actions
     QAction* m_detailViewAction;
@@ -172,7 +173,7 @@ private:
     
     // Models
     RomListModel* m_romListModel;
-    QSortFilterProxyModel* m_proxyModel;
+    RomSortFilterProxy* m_proxyModel;
     RomGridDelegate* m_gridDelegate;
     
     // State
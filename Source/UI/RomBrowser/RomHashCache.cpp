@@ -0,0 +1,235 @@
+#include "RomHashCache.h"
+#include "../../Core/RomInfoProvider.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace QT_UI {
+
+// Bump CACHE_VERSION whenever the record layout or the hashed byte order changes
+static const quint32 CACHE_MAGIC = 0x50363448; // "P64H"
+static const quint32 CACHE_VERSION = 2;
+
+static QDataStream& operator<<(QDataStream& out, const RomHashCache::FileIdentity& identity)
+{
+    return out << identity.size << identity.modified << identity.inode;
+}
+
+static QDataStream& operator>>(QDataStream& in, RomHashCache::FileIdentity& identity)
+{
+    return in >> identity.size >> identity.modified >> identity.inode;
+}
+
+static bool operator==(const RomHashCache::FileIdentity& a, const RomHashCache::FileIdentity& b)
+{
+    return a.size == b.size && a.modified == b.modified && a.inode == b.inode;
+}
+
+RomHashCache::RomHashCache(const QString& cacheFilePath)
+    : m_cacheFilePath(cacheFilePath)
+    , m_loaded(false)
+    , m_dirty(false)
+{
+}
+
+RomHashCache& RomHashCache::instance()
+{
+    static RomHashCache cache;
+    return cache;
+}
+
+QString RomHashCache::defaultCachePath()
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QCoreApplication::applicationDirPath();
+    }
+    return QDir(cacheDir).filePath("romhashes.cache");
+}
+
+bool RomHashCache::fileIdentity(const QString& filePath, FileIdentity& identity)
+{
+    // The inode catches a file replaced by another of the same size and mtime,
+    // e.g. restored from a backup or moved over the original
+#ifdef Q_OS_WIN
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists())
+        return false;
+
+    identity.size = fileInfo.size();
+    identity.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    identity.inode = 0;
+
+    HANDLE handle = CreateFileW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(filePath).utf16()),
+                                0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle != INVALID_HANDLE_VALUE) {
+        BY_HANDLE_FILE_INFORMATION info;
+        if (GetFileInformationByHandle(handle, &info)) {
+            identity.inode = (quint64(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        }
+        CloseHandle(handle);
+    }
+#else
+    // One stat() for size, mtime and inode
+    struct stat st;
+    if (::stat(QFile::encodeName(filePath).constData(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    identity.size = qint64(st.st_size);
+#ifdef Q_OS_MACOS
+    identity.modified = qint64(st.st_mtimespec.tv_sec) * 1000 + st.st_mtimespec.tv_nsec / 1000000;
+#else
+    identity.modified = qint64(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+#endif
+    identity.inode = quint64(st.st_ino);
+#endif
+
+    return true;
+}
+
+bool RomHashCache::load()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_loaded)
+        return !m_entries.isEmpty();
+    m_loaded = true;
+
+    QFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || in.status() != QDataStream::Ok) {
+        qDebug() << "Ignoring incompatible ROM hash cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        in >> path >> entry.identity >> entry.hashes.md5 >> entry.hashes.sha1 >> entry.hashes.crc32
+           >> entry.hashes.checksumValid;
+        m_entries.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "ROM hash cache is truncated or corrupt, discarding:" << m_cacheFilePath;
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool RomHashCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_dirty)
+        return true;
+
+    QDir().mkpath(QFileInfo(m_cacheFilePath).absolutePath());
+
+    QSaveFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write ROM hash cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CACHE_MAGIC << CACHE_VERSION << quint32(m_entries.size());
+
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->identity << it->hashes.md5 << it->hashes.sha1 << it->hashes.crc32
+            << it->hashes.checksumValid;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "Failed to commit ROM hash cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+bool RomHashCache::lookup(const QString& romKey, const FileIdentity& identity, Hashes& hashes) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.constFind(romKey);
+    if (it == m_entries.cend() || !(it->identity == identity))
+        return false;
+
+    hashes = it->hashes;
+    return true;
+}
+
+void RomHashCache::insert(const QString& romKey, const FileIdentity& identity, const Hashes& hashes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry& entry = m_entries[romKey];
+    entry.identity = identity;
+    entry.hashes = hashes;
+    m_dirty = true;
+}
+
+void RomHashCache::prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths)
+{
+    load();
+
+    QMutexLocker locker(&m_mutex);
+
+    // Paths are keyed exactly as the scanner's QDirIterator reports them; keys
+    // of archive members extend the archive's path by "/<member>"
+    QString prefix = QDir::cleanPath(directory) + '/';
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const QString& key = it.key();
+
+        // The file a key belongs to: the archive holding it, or the key itself
+        QString filePath = key;
+        for (int slash = key.indexOf('/', prefix.size()); slash >= 0; slash = key.indexOf('/', slash + 1)) {
+            if (RomInfoProvider::isArchive(key.left(slash))) {
+                filePath = key.left(slash);
+                break;
+            }
+        }
+
+        bool inScope = filePath.startsWith(prefix) &&
+                       (recursive || filePath.indexOf('/', prefix.size()) < 0);
+        if (inScope && !seenPaths.contains(filePath)) {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace QT_UI
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+
+namespace QT_UI {
+
+/**
+ * @brief Persistent on-disk cache of full-ROM hashes
+ *
+ * Stores the MD5, SHA-1 and CRC32 of each hashed ROM keyed by ROM key (the
+ * file path, plus the member name for ROMs in archives) and validated by the
+ * file's size, modification time and inode (file index on Windows), so a ROM
+ * is only hashed again after its file was modified or replaced.
+ * Unlike RomLibraryCache, entries do not depend on the ROM database and
+ * survive database updates.
+ *
+ * All methods are thread-safe; hash workers look up and insert concurrently.
+ */
+class RomHashCache
+{
+public:
+    /**
+     * @brief Identifies one version of a file on disk
+     */
+    struct FileIdentity {
+        qint64 size = -1;
+        qint64 modified = 0; // ms since epoch
+        quint64 inode = 0;   // 0 where the platform provides none
+    };
+
+    /**
+     * @brief Hashes of one ROM in Z64 byte order, as lowercase hex, and the
+     *        boot checksum check done in the same pass; the digests are empty
+     *        for ROMs only checked by a checksum-only pass
+     */
+    struct Hashes {
+        QString md5;
+        QString sha1;
+        QString crc32;
+        bool checksumValid = true; // False if the boot checksum contradicts the header CRCs
+    };
+
+    explicit RomHashCache(const QString& cacheFilePath = defaultCachePath());
+
+    /**
+     * @brief Gets the process-wide cache, shared by the hasher and the scanner
+     */
+    static RomHashCache& instance();
+
+    /**
+     * @brief Loads the cache from disk (only the first call does any work)
+     * @return True if a valid cache was read
+     */
+    bool load();
+
+    /**
+     * @brief Writes the cache to disk if it changed since the last load/save
+     * @return True on success or if nothing needed saving
+     */
+    bool save();
+
+    /**
+     * @brief Looks up the hashes of a file, validating them against its current identity
+     * @return True if a valid entry exists
+     */
+    bool lookup(const QString& romKey, const FileIdentity& identity, Hashes& hashes) const;
+
+    /**
+     * @brief Adds or replaces the hashes of a file
+     */
+    void insert(const QString& romKey, const FileIdentity& identity, const Hashes& hashes);
+
+    /**
+     * @brief Removes ROMs below a directory whose files were not seen by a completed scan
+     * @param directory Scanned directory
+     * @param recursive Whether the scan included subdirectories
+     * @param seenPaths Files found by the scan; archive members go with their archive
+     */
+    void prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths);
+
+    /**
+     * @brief Reads a file's size, modification time and inode
+     * @return False if the file does not exist
+     */
+    static bool fileIdentity(const QString& filePath, FileIdentity& identity);
+
+    static QString defaultCachePath();
+
+private:
+    struct Entry {
+        FileIdentity identity;
+        Hashes hashes;
+    };
+
+    QString m_cacheFilePath;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    bool m_loaded;
+    bool m_dirty;
+};
+
+} // namespace QT_UI
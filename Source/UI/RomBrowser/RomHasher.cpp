@@ -0,0 +1,385 @@
+#include "RomHasher.h"
+#include <Core/RomParser.h>
+#include <Core/RomImage.h>
+#include <Core/ZipArchive.h>
+#include <Core/SevenZipArchive.h>
+#include <Core/RomInfoProvider.h>
+#include <Core/DatabaseManager.h>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QDebug>
+#include <cstring>
+
+namespace QT_UI {
+
+// Same cadence as the scanner, so the view is updated a few times per second
+const int HASH_FLUSH_INTERVAL_MS = 150;
+
+// Bytes hashed per step; a multiple of 4 so byte order conversion never splits a word
+const int HASH_CHUNK_SIZE = 1024 * 1024;
+
+/**
+ * Shared between the hasher and its pool tasks; replaced on cancel() so late
+ * results of dropped work can be recognized on the owning thread.
+ */
+struct RomHasher::HashState {
+    QAtomicInt cancelled { 0 };
+    QAtomicInt pending { 0 };
+    QSet<QString> queued;         // ROM keys; only touched on the owning thread
+    QSet<QString> queuedChecksums; // ROM keys of checksum-only requests
+
+    QMutex resultsMutex;
+    QVector<RomHashResult> results;
+};
+
+RomHasher::RomHasher(QObject* parent)
+    : QObject(parent)
+    , m_cache(RomHashCache::instance())
+{
+    // Hashing is bound by disk reads; a few parallel streams saturate an SSD,
+    // and more would only make spinning disks seek and starve the scanner
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+
+    m_flushTimer.setInterval(HASH_FLUSH_INTERVAL_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &RomHasher::flushResults);
+}
+
+RomHasher::~RomHasher()
+{
+    if (m_state) {
+        m_state->cancelled.storeRelaxed(1);
+        m_state.reset();
+    }
+
+    // Tasks capture 'this', so they must be gone before we are
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    // Keep what was hashed so far, even if the work was interrupted
+    m_cache.save();
+}
+
+void RomHasher::enqueue(const QVector<RomHashRequest>& requests)
+{
+    if (!m_state) {
+        m_state = std::make_shared<HashState>();
+    }
+
+    std::shared_ptr<HashState> state = m_state;
+    for (const RomHashRequest& request : requests) {
+        // A full hash also verifies the checksum
+        const QString key = RomInfoProvider::romKey(request.filePath, request.memberName);
+        if (state->queued.contains(key))
+            continue;
+        if (request.checksumOnly) {
+            if (state->queuedChecksums.contains(key))
+                continue;
+            state->queuedChecksums.insert(key);
+        } else {
+            state->queued.insert(key);
+        }
+
+        state->pending.ref();
+        m_pool.start([this, state, request]() { hashTask(state, request); });
+    }
+
+    if (state->pending.loadRelaxed() > 0 && !m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void RomHasher::cancel()
+{
+    if (!m_state)
+        return;
+
+    m_state->cancelled.storeRelaxed(1);
+    m_state.reset();
+    m_pool.clear();
+    m_flushTimer.stop();
+}
+
+bool RomHasher::isRunning() const
+{
+    return m_state && m_state->pending.loadRelaxed() > 0;
+}
+
+/**
+ * Feeds ROM data in Z64 byte order to all digests in one pass, while each
+ * chunk is still in cache.
+ */
+class RomDigests
+{
+public:
+    RomDigests()
+        : m_md5(QCryptographicHash::Md5)
+        , m_sha1(QCryptographicHash::Sha1)
+        , m_crc32(0)
+    {
+    }
+
+    void addData(const char* data, qint64 size)
+    {
+        const QByteArray view = QByteArray::fromRawData(data, static_cast<int>(size));
+        m_md5.addData(view);
+        m_sha1.addData(view);
+        m_crc32 = RomParser::updateCrc32(m_crc32, data, size);
+    }
+
+    void result(RomHashCache::Hashes& hashes) const
+    {
+        hashes.md5 = QString::fromLatin1(m_md5.result().toHex());
+        hashes.sha1 = QString::fromLatin1(m_sha1.result().toHex());
+        hashes.crc32 = QString::number(m_crc32, 16).rightJustified(8, '0');
+    }
+
+private:
+    QCryptographicHash m_md5;
+    QCryptographicHash m_sha1;
+    quint32 m_crc32;
+};
+
+/**
+ * Checks the header CRCs of a ROM against its boot checksum, given the start
+ * of the ROM in Z64 order. ROMs whose checksum cannot be computed (unknown
+ * boot code, shorter than the checksum region) are not flagged.
+ */
+static bool bootChecksumMatches(const char* z64Data, qint64 size)
+{
+    RomParser parser;
+    if (size < RomParser::BOOT_CHECKSUM_END ||
+        !parser.setRomData(QByteArray::fromRawData(z64Data, static_cast<int>(RomParser::BOOT_AREA_SIZE))))
+        return true;
+
+    uint32_t crc1 = 0, crc2 = 0;
+    if (!RomParser::calculateBootChecksum(z64Data, size, parser.detectCICChip(), crc1, crc2))
+        return true;
+
+    uint32_t headerCrc1 = 0, headerCrc2 = 0;
+    parser.calculateCRC(headerCrc1, headerCrc2);
+    return crc1 == headerCrc1 && crc2 == headerCrc2;
+}
+
+template <typename Archive>
+static bool hashArchivedRom(const QString& filePath, const QString& memberName, RomHashCache::Hashes& hashes)
+{
+    Archive archive;
+    if (!archive.open(filePath))
+        return false;
+
+    const QVector<typename Archive::Entry> roms = archive.romEntries();
+    auto rom = roms.cbegin();
+    while (rom != roms.cend() && !memberName.isEmpty() && rom->name != memberName)
+        ++rom;
+    if (rom == roms.cend())
+        return false;
+
+    // Decoded chunks are full-sized, hence word aligned, except the last one.
+    // The checksum region is kept aside as it streams past.
+    RomDigests digests;
+    RomByteFormat format = Format_Unknown;
+    bool firstChunk = true;
+    QByteArray checksumRegion;
+    bool ok = archive.stream(*rom, HASH_CHUNK_SIZE, [&](char* data, qint64 size) {
+        if (firstChunk) {
+            format = RomParser::detectByteFormat(data, size);
+            firstChunk = false;
+        }
+        RomParser::convertToZ64InPlace(data, size, format);
+        digests.addData(data, size);
+        if (checksumRegion.size() < RomParser::BOOT_CHECKSUM_END) {
+            checksumRegion.append(data, static_cast<int>(qMin<qint64>(size, RomParser::BOOT_CHECKSUM_END - checksumRegion.size())));
+        }
+        return true;
+    });
+
+    if (!ok)
+        return false;
+
+    digests.result(hashes);
+    hashes.checksumValid = bootChecksumMatches(checksumRegion.constData(), checksumRegion.size());
+    return true;
+}
+
+template <typename Archive>
+static bool readArchivedChecksumRegion(const QString& filePath, const QString& memberName, QByteArray& region)
+{
+    Archive archive;
+    if (!archive.open(filePath))
+        return false;
+
+    const QVector<typename Archive::Entry> roms = archive.romEntries();
+    auto rom = roms.cbegin();
+    while (rom != roms.cend() && !memberName.isEmpty() && rom->name != memberName)
+        ++rom;
+    if (rom == roms.cend())
+        return false;
+
+    region = archive.read(*rom, RomParser::BOOT_CHECKSUM_END);
+    return !region.isEmpty();
+}
+
+bool RomHasher::checkBootChecksum(const QString& filePath, const QString& memberName, RomHashCache::Hashes& hashes)
+{
+    QByteArray region;
+    bool ok = false;
+    if (filePath.endsWith(".zip", Qt::CaseInsensitive)) {
+        ok = readArchivedChecksumRegion<ZipArchive>(filePath, memberName, region);
+    } else if (filePath.endsWith(".7z", Qt::CaseInsensitive)) {
+        ok = readArchivedChecksumRegion<SevenZipArchive>(filePath, memberName, region);
+    } else {
+        qint64 fileSize = -1;
+        ok = RomImage::readHead(filePath, RomParser::BOOT_CHECKSUM_END, region, fileSize);
+    }
+    if (!ok)
+        return false;
+
+    const RomByteFormat format = RomParser::detectByteFormat(region.constData(), region.size());
+    RomParser::convertToZ64InPlace(region.data(), region.size(), format);
+
+    hashes = RomHashCache::Hashes();
+    hashes.checksumValid = bootChecksumMatches(region.constData(), region.size());
+    return true;
+}
+
+bool RomHasher::hashFile(const QString& filePath, const QString& memberName, RomHashCache::Hashes& hashes)
+{
+    if (filePath.endsWith(".zip", Qt::CaseInsensitive))
+        return hashArchivedRom<ZipArchive>(filePath, memberName, hashes);
+    if (filePath.endsWith(".7z", Qt::CaseInsensitive))
+        return hashArchivedRom<SevenZipArchive>(filePath, memberName, hashes);
+
+    RomImage image;
+    if (!image.open(filePath))
+        return false;
+    image.adviseSequential();
+
+    // Z64 images are hashed straight from the mapping. Other byte orders go
+    // through one reused scratch buffer rather than RomImage's in-place
+    // conversion, which would leave a private copy of every page of the ROM.
+    const bool needsConversion = image.byteFormat() == Format_N64 || image.byteFormat() == Format_V64;
+    QByteArray scratch;
+    if (needsConversion) {
+        scratch.resize(HASH_CHUNK_SIZE);
+    }
+
+    RomDigests digests;
+    for (qint64 offset = 0; offset < image.size(); offset += HASH_CHUNK_SIZE) {
+        const qint64 length = qMin<qint64>(HASH_CHUNK_SIZE, image.size() - offset);
+        const char* chunk = image.rawData() + offset;
+        if (needsConversion) {
+            memcpy(scratch.data(), chunk, static_cast<size_t>(length));
+            RomParser::convertToZ64InPlace(scratch.data(), length, image.byteFormat());
+            chunk = scratch.constData();
+        }
+        digests.addData(chunk, length);
+    }
+
+    digests.result(hashes);
+
+    // The checksum region is converted once more on its own; that is a
+    // megabyte against a hashing pass over the whole ROM
+    const qint64 checksumSize = qMin(image.size(), RomParser::BOOT_CHECKSUM_END);
+    if (needsConversion) {
+        QByteArray checksumRegion(image.rawData(), static_cast<int>(checksumSize));
+        RomParser::convertToZ64InPlace(checksumRegion.data(), checksumSize, image.byteFormat());
+        hashes.checksumValid = bootChecksumMatches(checksumRegion.constData(), checksumSize);
+    } else {
+        hashes.checksumValid = bootChecksumMatches(image.rawData(), checksumSize);
+    }
+    return true;
+}
+
+void RomHasher::hashTask(std::shared_ptr<HashState> state, const RomHashRequest& request)
+{
+    if (!state->cancelled.loadRelaxed()) {
+        // Keep the browser and the scanner ahead of background hashing
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+
+        m_cache.load();
+
+        // Unchanged files are served from the hash cache without being read;
+        // archive members are cached per member, validated by the archive file
+        const QString key = RomInfoProvider::romKey(request.filePath, request.memberName);
+        RomHashCache::FileIdentity identity;
+        RomHashCache::Hashes hashes;
+        bool hashed = false;
+        if (RomHashCache::fileIdentity(request.filePath, identity)) {
+            // Entries of a checksum-only pass have no digests yet
+            hashed = m_cache.lookup(key, identity, hashes) &&
+                     (request.checksumOnly || !hashes.md5.isEmpty());
+            if (!hashed) {
+                hashed = request.checksumOnly
+                             ? checkBootChecksum(request.filePath, request.memberName, hashes)
+                             : hashFile(request.filePath, request.memberName, hashes);
+                if (hashed) {
+                    m_cache.insert(key, identity, hashes);
+                }
+            }
+        }
+
+        if (hashed && !state->cancelled.loadRelaxed()) {
+            RomHashResult result;
+            result.filePath = request.filePath;
+            result.memberName = request.memberName;
+            result.md5 = hashes.md5;
+            result.sha1 = hashes.sha1;
+            result.crc32 = hashes.crc32;
+            result.checksumValid = hashes.checksumValid;
+
+            DatabaseManager& db = DatabaseManager::instance();
+            if (!result.md5.isEmpty() && db.isDatabaseLoaded()) {
+                bool verified = false;
+                result.verified = db.findRomHash(result.md5, result.sha1, verified) && verified;
+            }
+
+            QMutexLocker locker(&state->resultsMutex);
+            state->results.append(result);
+        }
+    }
+
+    finishTask(state);
+}
+
+void RomHasher::flushResults()
+{
+    if (!m_state)
+        return;
+
+    QVector<RomHashResult> batch;
+    {
+        QMutexLocker locker(&m_state->resultsMutex);
+        batch.swap(m_state->results);
+    }
+
+    if (!batch.isEmpty()) {
+        emit romsHashed(batch);
+    }
+}
+
+void RomHasher::finishTask(std::shared_ptr<HashState> state)
+{
+    // The last task reports completion, unless more files were queued meanwhile
+    if (!state->pending.deref()) {
+        QMetaObject::invokeMethod(this, [this, state]() {
+            if (state != m_state || state->pending.loadRelaxed() > 0)
+                return;
+
+            flushResults();
+            m_flushTimer.stop();
+            m_state.reset();
+
+            // Persist new hashes off the GUI thread
+            m_pool.start([this]() { m_cache.save(); });
+
+            emit finished();
+        }, Qt::QueuedConnection);
+    }
+}
+
+} // namespace QT_UI
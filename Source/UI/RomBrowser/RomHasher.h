@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <memory>
+
+#include "RomHashCache.h"
+
+namespace QT_UI {
+
+/**
+ * @brief A ROM to hash: a ROM file, or one member of an archive
+ */
+struct RomHashRequest {
+    QString filePath;
+    QString memberName; // Empty for plain ROM files
+    bool checksumOnly = false; // Only verify the boot checksum, reading the first megabyte
+};
+
+/**
+ * @brief Result of hashing one ROM
+ */
+struct RomHashResult {
+    QString filePath;
+    QString memberName;
+    QString md5;  // Digests are empty for checksum-only requests
+    QString sha1;
+    QString crc32;
+    bool verified = false; // Hash matches a verified rom_hashes entry
+    bool checksumValid = true; // Boot checksum agrees with the header CRCs
+};
+
+/**
+ * @brief Background full-ROM hasher
+ *
+ * Streams each queued ROM once through MD5 and SHA-1 together on a small
+ * worker pool and checks the result against the rom_hashes table. Files are
+ * hashed in native Z64 byte order, so the same dump in .n64/.v64 form hashes
+ * the same. The boot checksum is verified in the same pass, since library
+ * scans only read the boot area; checksum-only requests verify it without
+ * hashing, from the first megabyte of the ROM. Results are handed to the
+ * owning thread in time-sliced batches.
+ *
+ * Hashes are kept in a persistent RomHashCache, so an unchanged file is only
+ * ever read once.
+ */
+class RomHasher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RomHasher(QObject* parent = nullptr);
+    ~RomHasher();
+
+    /**
+     * @brief Queues ROMs for hashing; ROMs already queued are skipped
+     */
+    void enqueue(const QVector<RomHashRequest>& requests);
+
+    /**
+     * @brief Drops all queued work; results still in flight are discarded
+     */
+    void cancel();
+
+    /**
+     * @brief Gets whether files are queued or being hashed
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Computes MD5, SHA-1 and CRC32 of a ROM, or of a ROM in a ZIP or 7z
+     *        archive (the first one if memberName is empty), in Z64 byte order,
+     *        and checks its boot checksum in a single read pass
+     * @return False if the file could not be read
+     */
+    static bool hashFile(const QString& filePath, const QString& memberName, RomHashCache::Hashes& hashes);
+
+    /**
+     * @brief Verifies the boot checksum of a ROM, or of a ROM in a ZIP or 7z
+     *        archive, reading only the checksummed region; digests are left empty
+     * @return False if the file could not be read
+     */
+    static bool checkBootChecksum(const QString& filePath, const QString& memberName, RomHashCache::Hashes& hashes);
+
+signals:
+    void romsHashed(const QVector<QT_UI::RomHashResult>& results);
+    void finished();
+
+private slots:
+    void flushResults();
+
+private:
+    struct HashState;
+
+    void hashTask(std::shared_ptr<HashState> state, const RomHashRequest& request);
+    void finishTask(std::shared_ptr<HashState> state);
+
+    RomHashCache& m_cache; // RomHashCache::instance()
+    QThreadPool m_pool;
+    std::shared_ptr<HashState> m_state;
+    QTimer m_flushTimer;
+};
+
+} // namespace QT_UI
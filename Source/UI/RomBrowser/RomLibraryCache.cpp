@@ -0,0 +1,252 @@
+#include "RomLibraryCache.h"
+#include <Core/StringPool.h>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace QT_UI {
+
+// Bump CACHE_VERSION whenever the record layout or RomInfo resolution changes
+static const quint32 CACHE_MAGIC = 0x50363443; // "P64C"
+static const quint32 CACHE_VERSION = 6;
+
+static void writeRomInfo(QDataStream& out, const RomInfo& info)
+{
+    out << info.fileName << info.goodName << info.internalName << info.romSize
+        << info.country << info.releaseDate << qint32(info.players) << info.genre
+        << info.developer << info.crc1 << info.crc2 << info.md5 << info.sha1 << info.crc32 << info.filePath
+        << info.memberName << info.cartID << info.mediaType << info.cartridgeCode << qint32(info.cicChip)
+        << info.status << info.headerParsed << info.isGoodDump << info.checksumChecked
+        << info.isVerifiedDump << info.forceFeedback
+        << info.hasBeenPlayed << info.lastPlayed << qint32(info.playCount)
+        << info.coverPath << info.hasCover;
+}
+
+static void readRomInfo(QDataStream& in, RomInfo& info)
+{
+    qint32 players = 0;
+    qint32 cicChip = CIC_UNKNOWN;
+    qint32 playCount = 0;
+    in >> info.fileName >> info.goodName >> info.internalName >> info.romSize
+       >> info.country >> info.releaseDate >> players >> info.genre
+       >> info.developer >> info.crc1 >> info.crc2 >> info.md5 >> info.sha1 >> info.crc32 >> info.filePath
+       >> info.memberName >> info.cartID >> info.mediaType >> info.cartridgeCode >> cicChip
+       >> info.status >> info.headerParsed >> info.isGoodDump >> info.checksumChecked
+       >> info.isVerifiedDump >> info.forceFeedback
+       >> info.hasBeenPlayed >> info.lastPlayed >> playCount
+       >> info.coverPath >> info.hasCover;
+    // Repeated values share the pooled copies the model uses
+    StringPool& pool = StringPool::instance();
+    info.country = pool.shared(info.country);
+    info.releaseDate = pool.shared(info.releaseDate);
+    info.genre = pool.shared(info.genre);
+    info.developer = pool.shared(info.developer);
+    info.mediaType = pool.shared(info.mediaType);
+    info.status = pool.shared(info.status);
+    info.players = players;
+    info.cicChip = static_cast<CICChip>(cicChip);
+    info.playCount = playCount;
+}
+
+RomLibraryCache::RomLibraryCache(const QString& cacheFilePath)
+    : m_cacheFilePath(cacheFilePath)
+    , m_loaded(false)
+    , m_dirty(false)
+{
+}
+
+QString RomLibraryCache::defaultCachePath()
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QCoreApplication::applicationDirPath();
+    }
+    return QDir(cacheDir).filePath("romlibrary.cache");
+}
+
+QString RomLibraryCache::databaseStamp()
+{
+    // Cached records embed database lookups, so they are only valid for the same database file
+    QFileInfo dbInfo(QDir(QCoreApplication::applicationDirPath()).filePath("database.sqlite"));
+    return QString("%1:%2").arg(dbInfo.size()).arg(dbInfo.lastModified().toMSecsSinceEpoch());
+}
+
+QString RomLibraryCache::coverDirectoryStamp(const QString& coverDirectory)
+{
+    QFileInfo dirInfo(coverDirectory);
+    if (coverDirectory.isEmpty() || !dirInfo.isDir()) {
+        return QString();
+    }
+    return QString("%1|%2").arg(dirInfo.absoluteFilePath())
+                           .arg(dirInfo.lastModified().toMSecsSinceEpoch());
+}
+
+bool RomLibraryCache::load()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_loaded)
+        return !m_entries.isEmpty();
+    m_loaded = true;
+
+    QFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0, version = 0;
+    QString dbStamp;
+    quint32 count = 0;
+    in >> magic >> version >> dbStamp >> count;
+
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || in.status() != QDataStream::Ok) {
+        qDebug() << "Ignoring incompatible ROM library cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    if (dbStamp != databaseStamp()) {
+        qDebug() << "ROM database changed, discarding ROM library cache";
+        m_dirty = true;
+        return false;
+    }
+
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        quint32 romCount = 0;
+        in >> path >> entry.size >> entry.modified >> entry.coverStamp >> romCount;
+        for (quint32 r = 0; r < romCount && in.status() == QDataStream::Ok; ++r) {
+            RomInfo info;
+            readRomInfo(in, info);
+            entry.roms.append(info);
+        }
+        m_entries.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "ROM library cache is truncated or corrupt, discarding:" << m_cacheFilePath;
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool RomLibraryCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_dirty)
+        return true;
+
+    QDir().mkpath(QFileInfo(m_cacheFilePath).absolutePath());
+
+    QSaveFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write ROM library cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CACHE_MAGIC << CACHE_VERSION << databaseStamp() << quint32(m_entries.size());
+
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->coverStamp << quint32(it->roms.size());
+        for (const RomInfo& info : it->roms) {
+            writeRomInfo(out, info);
+        }
+    }
+
+    if (!file.commit()) {
+        qWarning() << "Failed to commit ROM library cache:" << m_cacheFilePath;
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+bool RomLibraryCache::lookup(const QString& filePath, qint64 size, qint64 modified,
+                             QVector<RomInfo>& roms, QString& coverStamp) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.constFind(filePath);
+    if (it == m_entries.cend() || it->size != size || it->modified != modified)
+        return false;
+
+    roms = it->roms;
+    coverStamp = it->coverStamp;
+    return true;
+}
+
+void RomLibraryCache::insert(const QString& filePath, const QVector<RomInfo>& roms,
+                             qint64 size, qint64 modified, const QString& coverStamp)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Entry& entry = m_entries[filePath];
+    entry.size = size;
+    entry.modified = modified;
+    entry.coverStamp = coverStamp;
+    entry.roms = roms;
+    m_dirty = true;
+}
+
+void RomLibraryCache::updateHashes(const QVector<RomInfo>& roms)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (const RomInfo& info : roms) {
+        auto it = m_entries.find(info.filePath);
+        if (it == m_entries.end())
+            continue;
+
+        for (RomInfo& cached : it->roms) {
+            if (cached.memberName != info.memberName)
+                continue;
+
+            cached.md5 = info.md5;
+            cached.sha1 = info.sha1;
+            cached.crc32 = info.crc32;
+            cached.isGoodDump = info.isGoodDump;
+            cached.checksumChecked = info.checksumChecked;
+            cached.isVerifiedDump = info.isVerifiedDump;
+            m_dirty = true;
+            break;
+        }
+    }
+}
+
+void RomLibraryCache::prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Paths are keyed exactly as the scanner's QDirIterator reports them
+    QString prefix = QDir::cleanPath(directory) + '/';
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const QString& path = it.key();
+        bool inScope = path.startsWith(prefix) &&
+                       (recursive || path.indexOf('/', prefix.size()) < 0);
+        if (inScope && !seenPaths.contains(path)) {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace QT_UI
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QMutex>
+
+#include "RomListModel.h"
+
+namespace QT_UI {
+
+/**
+ * @brief Persistent on-disk index of resolved ROM information
+ *
+ * Stores fully resolved RomInfo records keyed by file path and validated by
+ * file size and modification time, so a rescan only needs to stat files and
+ * re-parse the ones that are new or changed. An archive's entry holds one
+ * record per ROM member, so unchanged archives are never opened either. The
+ * whole index is dropped when the ROM database it was resolved against
+ * changes.
+ *
+ * All methods are thread-safe; scan workers look up and insert concurrently.
+ */
+class RomLibraryCache
+{
+public:
+    explicit RomLibraryCache(const QString& cacheFilePath = defaultCachePath());
+
+    /**
+     * @brief Loads the index from disk (only the first call does any work)
+     * @return True if a valid index was read
+     */
+    bool load();
+
+    /**
+     * @brief Writes the index to disk if it changed since the last load/save
+     * @return True on success or if nothing needed saving
+     */
+    bool save();
+
+    /**
+     * @brief Looks up a file, validating it against the file's current size and mtime
+     * @param filePath Path to the ROM file or archive
+     * @param size Current file size in bytes
+     * @param modified Current modification time (ms since epoch)
+     * @param roms Receives the cached records on a hit, one per ROM in the file
+     * @param coverStamp Receives the cover directory stamp the records were resolved with
+     * @return True if a valid entry exists
+     */
+    bool lookup(const QString& filePath, qint64 size, qint64 modified,
+                QVector<RomInfo>& roms, QString& coverStamp) const;
+
+    /**
+     * @brief Adds or replaces the records for a file
+     */
+    void insert(const QString& filePath, const QVector<RomInfo>& roms,
+                qint64 size, qint64 modified, const QString& coverStamp);
+
+    /**
+     * @brief Records the hashes and checksum results of ROMs already in the index
+     * @param roms ROMs whose md5, sha1, crc32 and dump flags replace the cached ones
+     */
+    void updateHashes(const QVector<RomInfo>& roms);
+
+    /**
+     * @brief Removes entries below a directory that were not seen by a completed scan
+     * @param directory Scanned directory
+     * @param recursive Whether the scan included subdirectories
+     * @param seenPaths Files found by the scan
+     */
+    void prune(const QString& directory, bool recursive, const QSet<QString>& seenPaths);
+
+    /**
+     * @brief Identifies a cover directory's state; changes when covers are added or removed
+     */
+    static QString coverDirectoryStamp(const QString& coverDirectory);
+
+    static QString defaultCachePath();
+
+private:
+    struct Entry {
+        qint64 size = -1;
+        qint64 modified = 0;
+        QString coverStamp;
+        QVector<RomInfo> roms;
+    };
+
+    static QString databaseStamp();
+
+    QString m_cacheFilePath;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    bool m_loaded;
+    bool m_dirty;
+};
+
+} // namespace QT_UI
@@ -1,5 +1,8 @@
 #include "RomListModel.h"
+#include "RomScanner.h"
+#include "RomHasher.h"
 #include <Core/RomInfoProvider.h>
+#include <Core/RomImage.h>
 #include <Core/Settings/SettingsManager.h>
 #include <Core/Settings/RomBrowserSettings.h>
 #include <UI/Theme/IconHelper.h>  // Add this include for IconHelper
@@ -10,14 +13,12 @@
 #include <QIcon>
 #include <QApplication>
 #include <QMimeDatabase>
-#include <QDirIterator>
-#include <QThread>
-#include <QFuture>
-#include <QtConcurrent/QtConcurrentRun>
 #include <QPainter>
 #include <QFont>
 #include <QStyledItemDelegate>
 #include <QRegularExpression>
+#include <QSet>
+#include <memory>
 
 namespace QT_UI {
 
@@ -33,6 +34,8 @@ RomListModel::RomListModel(QObject* parent)
     , m_baseCoverSize(DEFAULT_COVER_WIDTH, DEFAULT_COVER_HEIGHT)
     , m_currentViewMode(DetailView) // Default to detail view
     , m_showTitles(true) // Show titles by default
+    , m_scanner(new RomScanner(this))
+    , m_hasher(new RomHasher(this))
 {
     // We won't set any default columns here - we'll load them from settings instead
     // If no settings exist, we'll use defaults after trying to load
@@ -67,6 +70,12 @@ RomListModel::RomListModel(QObject* parent)
     // Load settings - this will set up the columns
     loadSettings();
     
+    // Scan results arrive on this thread through the scanner's queued calls
+    connect(m_scanner, &RomScanner::romsScanned, this, &RomListModel::appendRoms);
+    connect(m_scanner, &RomScanner::progress, this, &RomListModel::scanProgress);
+    connect(m_scanner, &RomScanner::finished, this, [this]() { emit scanFinished(); });
+    connect(m_hasher, &RomHasher::romsHashed, this, &RomListModel::applyHashResults);
+    
     qDebug() << "RomListModel initialized with" << m_visibleColumns.size() << "columns";
     for (int i = 0; i < m_visibleColumns.size(); i++) {
         qDebug() << "  Column" << i << ":" << columnNameFromEnum(m_visibleColumns[i]);
@@ -83,7 +92,7 @@ int RomListModel::rowCount(const QModelIndex& parent) const
     if (parent.isValid())
         return 0;
     
-    return m_romList.size();
+    return m_roms.size();
 }
 
 int RomListModel::columnCount(const QModelIndex& parent) const
@@ -96,63 +105,69 @@ int RomListModel::columnCount(const QModelIndex& parent) const
 
 QVariant RomListModel::data(const QModelIndex& index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_romList.size())
+    if (!index.isValid() || index.row() >= m_roms.size())
         return QVariant();
     
-    const RomInfo& romInfo = m_romList.at(index.row());
+    const int row = index.row();
     int column = m_visibleColumns.at(index.column());
     
+    // Text columns fall back to "Unknown"; numbers are formatted on demand
+    auto text = [](const QString& value) -> QVariant {
+        return value.isEmpty() ? tr("Unknown") : value;
+    };
+    const bool headerParsed = m_roms.hasFlag(row, RomStore::HeaderParsed);
+    
     switch (role) {
     case Qt::DisplayRole:
         switch (column) {
-        case FileName: return romInfo.fileName.isEmpty() ? tr("Unknown") : romInfo.fileName;
-        case GoodName: return romInfo.goodName.isEmpty() ? tr("Unknown") : romInfo.goodName;
-        case InternalName: return romInfo.internalName.isEmpty() ? tr("Unknown") : romInfo.internalName;
-        case Size: return romInfo.romSize.isEmpty() ? tr("Unknown") : romInfo.romSize;
-        case Country: return romInfo.country.isEmpty() ? tr("Unknown") : romInfo.country;
-        case ReleaseDate: return romInfo.releaseDate.isEmpty() ? tr("Unknown") : romInfo.releaseDate;
-        case Players: return romInfo.players.isEmpty() ? tr("Unknown") : romInfo.players;
-        case Genre: return romInfo.genre.isEmpty() ? tr("Unknown") : romInfo.genre;
-        case Developer: return romInfo.developer.isEmpty() ? tr("Unknown") : romInfo.developer;
-        case CRC1: return romInfo.crc1.isEmpty() ? tr("Unknown") : romInfo.crc1;
-        case CRC2: return romInfo.crc2.isEmpty() ? tr("Unknown") : romInfo.crc2;
-        case MD5: return romInfo.md5.isEmpty() ? tr("Unknown") : romInfo.md5;
-        case FilePath: return romInfo.filePath.isEmpty() ? tr("Unknown") : romInfo.filePath;
-        case CartID: return romInfo.cartID.isEmpty() ? tr("Unknown") : romInfo.cartID;
-        case MediaType: return romInfo.mediaType.isEmpty() ? tr("Unknown") : romInfo.mediaType;
-        case CartridgeCode: return romInfo.cartridgeCode.isEmpty() ? tr("Unknown") : romInfo.cartridgeCode; // Changed from ProductID & productID
-        case ForceFeedback: return romInfo.forceFeedback ? tr("Yes") : tr("No");
-        case CICChip: return romInfo.cicChip.isEmpty() ? tr("Unknown") : romInfo.cicChip;
-        case Status: return romInfo.status.isEmpty() ? tr("Unknown") : romInfo.status;
+        case FileName: return text(m_roms.fileName(row));
+        case GoodName: return text(m_roms.goodName(row));
+        case InternalName: return text(m_roms.internalName(row));
+        case Size: return m_roms.romSize(row) < 0 ? tr("Unknown") : sizeToString(m_roms.romSize(row));
+        case Country: return text(m_roms.country(row));
+        case ReleaseDate: return text(releaseDateToString(m_roms.releaseDate(row)));
+        case Players: return m_roms.players(row) > 0 ? QString::number(m_roms.players(row)) : tr("Unknown");
+        case Genre: return text(m_roms.genre(row));
+        case Developer: return text(m_roms.developer(row));
+        case CRC1: return headerParsed ? crcToString(m_roms.crc1(row)) : tr("Unknown");
+        case CRC2: return headerParsed ? crcToString(m_roms.crc2(row)) : tr("Unknown");
+        case MD5: return text(m_roms.md5(row));
+        case FilePath: return text(m_roms.filePath(row));
+        case CartID: return text(m_roms.cartID(row));
+        case MediaType: return text(m_roms.mediaType(row));
+        case CartridgeCode: return text(m_roms.cartridgeCode(row)); // Changed from ProductID & productID
+        case ForceFeedback: return m_roms.hasFlag(row, RomStore::ForceFeedback) ? tr("Yes") : tr("No");
+        case CICChip: return headerParsed ? cicChipToString(m_roms.cicChip(row)) : tr("Unknown");
+        case Status: return text(m_roms.status(row));
         default: return QVariant();
         }
     case Qt::DecorationRole:
         if (column == FileName) {
             // Return cover art image for grid view
-            if (m_currentViewMode == GridView && romInfo.hasCover) {
-                return getCoverImage(romInfo.filePath);
+            if (m_currentViewMode == GridView && m_roms.hasFlag(row, RomStore::HasCover)) {
+                return getCoverImage(m_roms.key(row));
             }
-            // Return default icon if the ROM doesn't have an icon
-            return romInfo.icon.isNull() ? m_defaultIcon : romInfo.icon;
+            return m_defaultIcon;
         }
         else if (column == Country) {
             // Get country code for icon
+            const QString& country = m_roms.country(row);
             QString countryCode;
-            if (romInfo.country.startsWith("USA") || romInfo.country.startsWith("America")) {
+            if (country.startsWith("USA") || country.startsWith("America")) {
                 countryCode = "USA";
-            } else if (romInfo.country.startsWith("Japan")) {
+            } else if (country.startsWith("Japan")) {
                 countryCode = "JP";
-            } else if (romInfo.country.startsWith("Europe")) {
+            } else if (country.startsWith("Europe")) {
                 countryCode = "EU";
-            } else if (romInfo.country.startsWith("Australia")) {
+            } else if (country.startsWith("Australia")) {
                 countryCode = "AU";
-            } else if (romInfo.country.startsWith("France")) {
+            } else if (country.startsWith("France")) {
                 countryCode = "FR";
-            } else if (romInfo.country.startsWith("Germany")) {
+            } else if (country.startsWith("Germany")) {
                 countryCode = "GE";
-            } else if (romInfo.country.startsWith("Italy")) {
+            } else if (country.startsWith("Italy")) {
                 countryCode = "IT";
-            } else if (romInfo.country.startsWith("Spain")) {
+            } else if (country.startsWith("Spain")) {
                 countryCode = "SP";
             } else {
                 countryCode = "OTHER";
@@ -162,17 +177,17 @@ QVariant RomListModel::data(const QModelIndex& index, int role) const
         return QVariant();
     // Custom role for grid view to access cover art
     case Qt::UserRole + 1:
-        return getCoverImage(romInfo.filePath);
+        return getCoverImage(m_roms.key(row));
     case Qt::UserRole + 2:
-        return romInfo.goodName.isEmpty() ? romInfo.fileName : romInfo.goodName;
+        return m_roms.goodName(row).isEmpty() ? m_roms.fileName(row) : m_roms.goodName(row);
     case Qt::ToolTipRole:
         return QString("%1\n%2\n%3\nPath: %4")
-            .arg(romInfo.fileName)
-            .arg(romInfo.goodName)
-            .arg(romInfo.romSize)
-            .arg(romInfo.filePath);
+            .arg(m_roms.fileName(row))
+            .arg(m_roms.goodName(row))
+            .arg(sizeToString(m_roms.romSize(row)))
+            .arg(m_roms.key(row));
     case Qt::UserRole:
-        return romInfo.filePath;
+        return m_roms.key(row);
     default:
         return QVariant();
     }
@@ -220,37 +235,20 @@ Qt::ItemFlags RomListModel::flags(const QModelIndex& index) const
 
 bool RomListModel::addRom(const QString& filePath)
 {
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists() || !fileInfo.isReadable())
-        return false;
-    
-    // Check if rom already exists in the list
-    if (m_pathToIndex.contains(filePath))
-        return false;
-    
-    RomInfo info;
-    if (loadRomInfo(filePath, info)) {
-        beginInsertRows(QModelIndex(), m_romList.size(), m_romList.size());
-        m_pathToIndex[filePath] = m_romList.size();
-        m_romList.append(info);
-        endInsertRows();
-        
-        emit romAdded(filePath);
-        return true;
-    }
-    
-    return false;
+    // Adds every ROM of an archive; ROMs already in the list are skipped, and
+    // a missing or unreadable file yields nothing
+    return appendRoms(loadRomInfos(QVector<RomFile>() << RomFile{ filePath }, m_coverDirectory)) > 0;
 }
 
-bool RomListModel::removeRom(const QString& filePath)
+bool RomListModel::removeRom(const QString& romKey)
 {
-    if (!m_pathToIndex.contains(filePath))
+    if (!m_pathToIndex.contains(romKey))
         return false;
     
-    int index = m_pathToIndex[filePath];
+    int index = m_pathToIndex[romKey];
     beginRemoveRows(QModelIndex(), index, index);
-    m_romList.removeAt(index);
-    m_pathToIndex.remove(filePath);
+    m_roms.removeAt(index);
+    m_pathToIndex.remove(romKey);
     
     // Update indices for remaining items
     for (auto it = m_pathToIndex.begin(); it != m_pathToIndex.end(); ++it) {
@@ -259,17 +257,19 @@ bool RomListModel::removeRom(const QString& filePath)
     }
     
     endRemoveRows();
-    emit romRemoved(filePath);
+    emit romRemoved(romKey);
     return true;
 }
 
 void RomListModel::clear()
 {
-    if (m_romList.isEmpty())
+    m_hasher->cancel();
+    
+    if (m_roms.isEmpty())
         return;
     
     beginResetModel();
-    m_romList.clear();
+    m_roms.clear();
     m_pathToIndex.clear();
     endResetModel();
 }
@@ -293,67 +293,139 @@ void RomListModel::scanDirectory(const QString& path, bool recursive)
     
     QDir dir(path);
     if (!dir.exists()) {
-        emit scanFinished();
+        if (m_scanner->isRunning())
+            m_scanner->cancel(); // Reports scanFinished through the scanner
+        else
+            emit scanFinished();
         return;
     }
     
-    // Get list of ROM file extensions
-    QStringList filters;
-    filters << "*.z64" << "*.v64" << "*.n64" << "*.zip";
-    
-    // Count total files for progress reporting
-    int totalFiles = 0;
-    if (recursive) {
-        QDirIterator it(path, filters, QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            it.next();
-            totalFiles++;
+    // Enumeration and parsing run on the scanner's worker pool; rows are
+    // appended in batches as results arrive (see appendRoms())
+    m_scanner->start(path, recursive, m_coverDirectory);
+}
+
+void RomListModel::cancelScan()
+{
+    m_scanner->cancel();
+}
+
+bool RomListModel::isScanning() const
+{
+    return m_scanner->isRunning();
+}
+
+int RomListModel::appendRoms(const QVector<RomInfo>& roms)
+{
+    // Skip ROMs that are already present (e.g. added manually during a scan)
+    QVector<const RomInfo*> newRoms;
+    newRoms.reserve(roms.size());
+    QSet<QString> batchKeys;
+    for (const RomInfo& info : roms) {
+        const QString key = info.key();
+        if (!m_pathToIndex.contains(key) && !batchKeys.contains(key)) {
+            batchKeys.insert(key);
+            newRoms.append(&info);
         }
-    } else {
-        dir.setNameFilters(filters);
-        totalFiles = dir.entryList(QDir::Files).count();
     }
     
-    // Scan directory
-    QDirIterator it(path, filters, QDir::Files, 
-                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    if (newRoms.isEmpty())
+        return 0;
+    
+    // One insertion for the whole batch, so attached proxies re-sort and
+    // re-filter once instead of once per ROM
+    int first = m_roms.size();
+    beginInsertRows(QModelIndex(), first, first + newRoms.size() - 1);
+    for (const RomInfo* info : newRoms) {
+        m_pathToIndex[info->key()] = m_roms.size();
+        m_roms.append(*info);
+    }
+    endInsertRows();
+    
+    for (const RomInfo* info : newRoms) {
+        emit romAdded(info->key());
+    }
+    
+    hashUnhashedRoms(first, m_roms.size() - 1);
+    
+    return newRoms.size();
+}
+
+void RomListModel::hashUnhashedRoms(int first, int last)
+{
+    // Full-file hashing reads every byte of every ROM, so it only runs
+    // while someone can actually see the result. The boot checksum, which
+    // decides whether a dump is good, only needs the first megabyte and is
+    // always verified. Rows restored from the library cache keep the flags
+    // of earlier checks, so only new or changed files are requested here.
+    const bool fullHashes = m_visibleColumns.contains(MD5);
+    
+    QVector<RomHashRequest> requests;
+    for (int row = qMax(0, first); row <= last && row < m_roms.size(); ++row) {
+        if (fullHashes && !m_roms.hasFlag(row, RomStore::Hashed)) {
+            requests.append(RomHashRequest{ m_roms.filePath(row), m_roms.memberName(row) });
+        } else if (m_roms.hasFlag(row, RomStore::HeaderParsed) &&
+                   !m_roms.hasFlag(row, RomStore::ChecksumChecked)) {
+            requests.append(RomHashRequest{ m_roms.filePath(row), m_roms.memberName(row), true });
+        }
+    }
     
-    int processedFiles = 0;
-    while (it.hasNext()) {
-        QString filePath = it.next();
-        addRom(filePath);
+    if (!requests.isEmpty())
+        m_hasher->enqueue(requests);
+}
+
+void RomListModel::applyHashResults(const QVector<RomHashResult>& results)
+{
+    int firstRow = -1;
+    int lastRow = -1;
+    QVector<RomInfo> checked;
+    for (const RomHashResult& result : results) {
+        auto it = m_pathToIndex.constFind(RomInfoProvider::romKey(result.filePath, result.memberName));
+        if (it == m_pathToIndex.cend())
+            continue; // Removed while it was being hashed
         
-        processedFiles++;
-        emit scanProgress(processedFiles, totalFiles);
+        int row = it.value();
+        if (!result.md5.isEmpty()) {
+            m_roms.setHashes(row, result.md5, result.sha1, result.crc32);
+            m_roms.setFlag(row, RomStore::VerifiedDump, result.verified);
+        }
+        m_roms.setFlag(row, RomStore::GoodDump, result.checksumValid);
+        m_roms.setFlag(row, RomStore::ChecksumChecked, true);
+        checked.append(m_roms.at(row));
         
-        // Process events to keep UI responsive
-        QApplication::processEvents();
+        firstRow = firstRow < 0 ? row : qMin(firstRow, row);
+        lastRow = qMax(lastRow, row);
     }
     
-    emit scanFinished();
+    if (firstRow >= 0)
+        emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
+    
+    // Restored with the rows on the next start, so they are not checked again
+    if (!checked.isEmpty())
+        m_scanner->updateHashes(checked);
 }
 
 RomInfo RomListModel::getRomInfo(int index) const
 {
-    if (index >= 0 && index < m_romList.size())
-        return m_romList.at(index);
+    if (index >= 0 && index < m_roms.size())
+        return m_roms.at(index);
     
     return RomInfo();
 }
 
-RomInfo RomListModel::getRomInfo(const QString& filePath) const
+RomInfo RomListModel::getRomInfo(const QString& romKey) const
 {
-    auto it = m_pathToIndex.find(filePath);
+    auto it = m_pathToIndex.find(romKey);
     if (it != m_pathToIndex.end())
-        return m_romList.at(it.value());
+        return m_roms.at(it.value());
     
     return RomInfo();
 }
 
 QString RomListModel::getRomPath(int index) const
 {
-    if (index >= 0 && index < m_romList.size())
-        return m_romList.at(index).filePath;
+    if (index >= 0 && index < m_roms.size())
+        return m_roms.filePath(index);
     
     return QString();
 }
@@ -397,6 +469,9 @@ void RomListModel::setVisibleColumns(const QVector<RomColumns>& columns)
     m_visibleColumns = columns;
     endResetModel();
     
+    // Start hashing if the MD5 column just became visible
+    hashUnhashedRoms(0, m_roms.size() - 1);
+    
     // Log for debugging
     debugPrintColumns();
     
@@ -456,123 +531,145 @@ void RomListModel::refreshRomList()
     refresh();
 }
 
-bool RomListModel::loadRomInfo(const QString& filePath, RomInfo& info)
+QVector<RomInfo> RomListModel::loadRomInfos(const QVector<RomFile>& files, const QString& coverDirectory)
 {
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists() || !fileInfo.isReadable())
-        return false;
+    // Parse all headers first, then resolve every parsed ROM against the
+    // database in a single batch query instead of one lookup per file
+    QVector<RomFile> romFiles;
+    QVector<RomInfoProvider::ArchivedRom> members; // Parallel to romFiles; empty for plain files
+    std::vector<std::unique_ptr<RomInfoProvider>> providers;
+    std::vector<DatabaseManager::RomKey> keys;
+    
+    for (const RomFile& file : files) {
+        // Archives are listed from their directory and contribute one entry per ROM
+        QVector<RomInfoProvider::ArchivedRom> archivedRoms;
+        if (RomInfoProvider::isArchive(file.path) &&
+            RomInfoProvider::readArchivedRoms(file.path, archivedRoms) && !archivedRoms.isEmpty()) {
+            for (const RomInfoProvider::ArchivedRom& rom : archivedRoms) {
+                auto provider = std::make_unique<RomInfoProvider>();
+                if (provider->openArchivedRom(file.path, rom, false)) {
+                    keys.push_back(provider->getRomKey());
+                } else {
+                    provider.reset();
+                }
+                
+                romFiles.append(file);
+                members.append(RomInfoProvider::ArchivedRom{ rom.memberName, rom.size, QByteArray() });
+                providers.push_back(std::move(provider));
+            }
+            continue;
+        }
+        
+        // Everything the list shows comes from the 4 KB boot area; the open
+        // doubles as the existence and permission check
+        RomFile romFile = file;
+        QByteArray head;
+        if (!RomImage::readHead(romFile.path, RomParser::BOOT_AREA_SIZE, head, romFile.size))
+            continue;
+        
+        // Archives without a readable ROM are only listed by name
+        auto provider = std::make_unique<RomInfoProvider>();
+        if (!RomInfoProvider::isArchive(romFile.path) &&
+            provider->openRomHead(romFile.path, head, romFile.size, false)) {
+            keys.push_back(provider->getRomKey());
+        } else {
+            provider.reset();
+        }
+        
+        romFiles.append(romFile);
+        members.append(RomInfoProvider::ArchivedRom());
+        providers.push_back(std::move(provider));
+    }
     
-    // Create ROM info provider
-    RomInfoProvider provider;
+    DatabaseManager& db = DatabaseManager::instance();
+    std::map<DatabaseManager::RomKey, RomBrowserEntry> entries;
+    if (db.isDatabaseLoaded()) {
+        entries = db.getRomBrowserEntriesByCRC(keys);
+    }
     
-    // Try to open and parse the ROM file
-    if (!provider.openRomFile(filePath)) {
+    QVector<RomInfo> infos(romFiles.size());
+    for (int i = 0; i < romFiles.size(); ++i) {
+        RomInfoProvider* provider = providers[i].get();
+        if (provider) {
+            auto it = entries.find(provider->getRomKey());
+            provider->applyDatabaseInfo(it != entries.end() ? it->second : RomBrowserEntry());
+        }
+        fillRomInfo(romFiles[i].path, romFiles[i].size, provider, coverDirectory, infos[i]);
+        
+        // A member that failed to parse still gets its own entry
+        if (!provider && !members[i].memberName.isEmpty()) {
+            infos[i].memberName = members[i].memberName;
+            infos[i].fileName = QFileInfo(members[i].memberName).fileName();
+            infos[i].romSize = members[i].size;
+            infos[i].goodName = infos[i].fileName.section('.', 0, -2);
+        }
+    }
+    
+    return infos;
+}
+
+void RomListModel::fillRomInfo(const QString& filePath, qint64 fileSize, const RomInfoProvider* provider,
+                               const QString& coverDirectory, RomInfo& info)
+{
+    if (!provider) {
         // Basic file information if we couldn't parse the ROM
-        info.fileName = fileInfo.fileName();
+        info.fileName = QFileInfo(filePath).fileName();
         info.filePath = filePath;
-        info.romSize = sizeToString(fileInfo.size());
-        info.icon = m_defaultIcon;
+        info.romSize = fileSize;
         info.goodName = info.fileName.section('.', 0, -2); // Remove extension
         info.isGoodDump = false;
         info.hasBeenPlayed = false;
         info.hasCover = false;
-        return true;
+        return;
     }
     
     // Fill in the ROM info from our provider
-    info.fileName = fileInfo.fileName();
+    info.fileName = provider->getFileName(); // The member's name for ROMs in archives
     info.filePath = filePath;
-    info.romSize = sizeToString(fileInfo.size());
-    info.icon = m_defaultIcon;
+    info.memberName = provider->getMemberName();
+    info.romSize = provider->getRomSize(); // Uncompressed size for archives
     
     // Enhanced ROM information
-    info.internalName = provider.getInternalName();
-    info.goodName = provider.getGoodName();
+    info.internalName = provider->getInternalName();
+    info.goodName = provider->getGoodName();
     if (info.goodName.isEmpty()) {
         info.goodName = info.fileName.section('.', 0, -2); // Use filename without extension as fallback
     }
     
-    info.country = provider.getCountryName();
-    info.crc1 = QString("0x%1").arg(provider.getCRC1(), 8, 16, QChar('0')).toUpper();
-    info.crc2 = QString("0x%1").arg(provider.getCRC2(), 8, 16, QChar('0')).toUpper();
-    info.cartID = provider.getCartID(); // Cart ID directly from ROM header
+    info.country = provider->getCountryName();
+    info.crc1 = provider->getCRC1();
+    info.crc2 = provider->getCRC2();
+    info.headerParsed = true;
+    info.cartID = provider->getCartID(); // Cart ID directly from ROM header
+    info.cicChip = provider->getCICChip();
     
     // Get and debug the media type to identify issues
-    info.mediaType = provider.getMediaType();
+    info.mediaType = provider->getMediaType();
     
     // Additional information from ROM database
-    info.developer = provider.getDeveloper();
-    info.releaseDate = provider.getReleaseDate();
-    info.genre = provider.getGenre();
-    info.players = QString::number(provider.getPlayers());
-    info.cartridgeCode = provider.getCartridgeCode(); // Now correctly gets cartridge_code from database
-    info.forceFeedback = provider.getForceFeedback();
-    
-    // Convert CIC chip enum to string representation
-    QT_UI::CICChip cicChip = provider.getCICChip();
-    switch(cicChip) {
-        case QT_UI::CIC_NUS_6101:
-            info.cicChip = "NUS-6101 (NTSC)";
-            break;
-        case QT_UI::CIC_NUS_6102:
-            info.cicChip = "NUS-6102 (NTSC)";
-            break;
-        case QT_UI::CIC_NUS_6103:
-            info.cicChip = "NUS-6103 (PAL)";
-            break;
-        case QT_UI::CIC_NUS_6105:
-            info.cicChip = "NUS-6105 (NTSC)";
-            break;
-        case QT_UI::CIC_NUS_6106:
-            info.cicChip = "NUS-6106 (PAL)";
-            break;
-        case QT_UI::CIC_NUS_5167:
-            info.cicChip = "NUS-5167 (ALECK64)";
-            break;
-        case QT_UI::CIC_NUS_8303:
-            info.cicChip = "NUS-8303 (64DD)";
-            break;
-        default:
-            info.cicChip = "Unknown";
-            break;
-    }
-    
-    info.status = provider.getStatus();
+    info.developer = provider->getDeveloper();
+    info.releaseDate = provider->getReleaseDate();
+    info.genre = provider->getGenre();
+    info.players = provider->getPlayers();
+    info.cartridgeCode = provider->getCartridgeCode(); // Now correctly gets cartridge_code from database
+    info.forceFeedback = provider->getForceFeedback();
+    info.status = provider->getStatus();
     
     // Add debug output to verify correct cartridge code retrieval
     qDebug() << "Loaded ROM:" << info.fileName 
              << "Cart ID:" << info.cartID
              << "Cartridge code (from DB):" << info.cartridgeCode;
              
-    // Format the release date nicely if possible (assuming YYYY-MM-DD format)
-    if (!info.releaseDate.isEmpty()) {
-        QStringList parts = info.releaseDate.split("-");
-        if (parts.size() == 3) {
-            // Format as Month Day, Year if it appears to be a valid date
-            bool yearOk = false, monthOk = false, dayOk = false;
-            int year = parts[0].toInt(&yearOk);
-            int month = parts[1].toInt(&monthOk);
-            int day = parts[2].toInt(&dayOk);
-            
-            if (yearOk && monthOk && dayOk && month > 0 && month <= 12 && day > 0 && day <= 31) {
-                QDate date(year, month, day);
-                if (date.isValid()) {
-                    info.releaseDate = date.toString("MMMM d, yyyy");
-                }
-            }
-        }
-    }
-    
-    // Status information
-    info.isGoodDump = true;
+    // Status information; scans only read the boot area, so the dump stays
+    // unverified until the hasher's checksum pass has run
+    info.isGoodDump = false;
+    info.checksumChecked = false;
     info.hasBeenPlayed = false;
     info.lastPlayed = QDateTime();
     info.playCount = 0;
     
     // Check for cover art
-    info.hasCover = findAndLoadCoverArt(filePath, info);
-    
-    return true;
+    info.hasCover = findAndLoadCoverArt(info.key(), coverDirectory, info);
 }
 
 void RomListModel::setCoverDirectory(const QString& directory)
@@ -606,12 +703,10 @@ QPixmap RomListModel::getCoverImage(const QString& romPath, bool loadIfNeeded) c
     if (loadIfNeeded) {
         int index = m_pathToIndex.value(romPath, -1);
         if (index >= 0) {
-            const RomInfo& info = m_romList.at(index);
-            
             QPixmap coverPixmap;
-            if (info.hasCover && !info.coverPath.isEmpty()) {
+            if (m_roms.hasFlag(index, RomStore::HasCover) && !m_roms.coverPath(index).isEmpty()) {
                 // Load the cover image
-                coverPixmap = QPixmap(info.coverPath);
+                coverPixmap = QPixmap(m_roms.coverPath(index));
                 if (coverPixmap.isNull()) {
                     // If loading fails, use default
                     coverPixmap = m_defaultCoverImage;
@@ -641,13 +736,14 @@ void RomListModel::refreshCovers()
     m_coverCache.clear();
     
     // Re-scan covers for all ROMs
-    for (int i = 0; i < m_romList.size(); ++i) {
-        RomInfo& info = m_romList[i];
-        info.hasCover = findAndLoadCoverArt(info.filePath, info);
+    for (int i = 0; i < m_roms.size(); ++i) {
+        RomInfo info = m_roms.at(i);
+        bool hasCover = findAndLoadCoverArt(info.key(), m_coverDirectory, info);
+        m_roms.setCover(i, info.coverPath, hasCover);
     }
     
     // Notify views of data change
-    emit dataChanged(index(0, 0), index(m_romList.size() - 1, columnCount() - 1));
+    emit dataChanged(index(0, 0), index(m_roms.size() - 1, columnCount() - 1));
 }
 
 void RomListModel::setViewMode(ViewMode mode)
@@ -716,9 +812,9 @@ QSize RomListModel::coverSize() const
                  m_baseCoverSize.height() * m_coverScale);
 }
 
-bool RomListModel::findAndLoadCoverArt(const QString& romPath, RomInfo& info)
+bool RomListModel::findAndLoadCoverArt(const QString& romPath, const QString& coverDirectory, RomInfo& info)
 {
-    if (m_coverDirectory.isEmpty() || !QDir(m_coverDirectory).exists()) {
+    if (coverDirectory.isEmpty() || !QDir(coverDirectory).exists()) {
         return false;
     }
     
@@ -756,9 +852,11 @@ bool RomListModel::findAndLoadCoverArt(const QString& romPath, RomInfo& info)
     }
     
     // 4. Try by CRC values if available
-    if (!info.crc1.isEmpty() && !info.crc2.isEmpty()) {
-        possibleNames << QString("%1-%2").arg(info.crc1).arg(info.crc2);
-        possibleNames << QString("%1%2").arg(info.crc1.mid(2)).arg(info.crc2.mid(2)); // Without 0x prefix
+    if (info.headerParsed) {
+        const QString crc1 = crcToString(info.crc1);
+        const QString crc2 = crcToString(info.crc2);
+        possibleNames << QString("%1-%2").arg(crc1).arg(crc2);
+        possibleNames << QString("%1%2").arg(crc1.mid(2)).arg(crc2.mid(2)); // Without 0x prefix
     }
     
     // 5. Try by file name
@@ -783,7 +881,7 @@ bool RomListModel::findAndLoadCoverArt(const QString& romPath, RomInfo& info)
     
     for (const QString& name : possibleNames) {
         for (const QString& ext : extensions) {
-            QString coverPath = QString("%1/%2.%3").arg(m_coverDirectory, name, ext);
+            QString coverPath = QString("%1/%2.%3").arg(coverDirectory, name, ext);
             QFileInfo coverInfo(coverPath);
             
             if (coverInfo.exists() && coverInfo.isReadable()) {
@@ -934,7 +1032,7 @@ QIcon QT_UI::RomListModel::getCountryIcon(const QString &countryCode) const
     return m_countryIcons.value("OTHER", QIcon());
 }
 
-QString QT_UI::RomListModel::sizeToString(long long size) const
+QString QT_UI::RomListModel::sizeToString(long long size)
 {
     const double KB = 1024.0;
     const double MB = 1024.0 * KB;
@@ -953,6 +1051,33 @@ QString QT_UI::RomListModel::sizeToString(long long size) const
     }
 }
 
+QString QT_UI::RomListModel::crcToString(quint32 crc)
+{
+    return QString("0x%1").arg(crc, 8, 16, QChar('0')).toUpper();
+}
+
+QString QT_UI::RomListModel::cicChipToString(CICChip cicChip)
+{
+    switch (cicChip) {
+    case QT_UI::CIC_NUS_6101: return "NUS-6101 (NTSC)";
+    case QT_UI::CIC_NUS_6102: return "NUS-6102 (NTSC)";
+    case QT_UI::CIC_NUS_6103: return "NUS-6103 (PAL)";
+    case QT_UI::CIC_NUS_6105: return "NUS-6105 (NTSC)";
+    case QT_UI::CIC_NUS_6106: return "NUS-6106 (PAL)";
+    case QT_UI::CIC_NUS_5167: return "NUS-5167 (ALECK64)";
+    case QT_UI::CIC_NUS_8303: return "NUS-8303 (64DD)";
+    default: return "Unknown";
+    }
+}
+
+QString QT_UI::RomListModel::releaseDateToString(const QString& releaseDate)
+{
+    // Format as Month Day, Year if it is a valid YYYY-MM-DD date; anything
+    // else (e.g. a year alone) is shown as stored
+    const QDate date = QDate::fromString(releaseDate, Qt::ISODate);
+    return date.isValid() ? date.toString("MMMM d, yyyy") : releaseDate;
+}
+
 // Grid view delegate implementation
 RomGridDelegate::RomGridDelegate(RomListModel* model, QObject* parent)
     : QStyledItemDelegate(parent)
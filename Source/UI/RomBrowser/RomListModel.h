@@ -11,9 +11,14 @@
 #include <QCache>
 #include <QtWidgets/QStyledItemDelegate>
 #include "../../Core/RomInfoProvider.h"
+#include "RomStore.h"
 
 namespace QT_UI {
 
+class RomScanner;
+class RomHasher;
+struct RomHashResult;
+
 /**
  * @brief Structure to hold ROM information
  */
@@ -21,33 +26,41 @@ struct RomInfo {
     QString fileName;
     QString goodName;
     QString internalName;
-    QString romSize;
+    qint64 romSize = -1; // Uncompressed size in bytes, -1 if unknown
     QString country;
-    QString releaseDate;
-    QString players;
+    QString releaseDate; // As stored in the database, usually YYYY-MM-DD
+    int players = 0; // 0 if unknown
     QString genre;
     QString developer;
-    QString crc1;
-    QString crc2;
+    quint32 crc1 = 0; // Header CRCs, valid if headerParsed
+    quint32 crc2 = 0;
     QString md5;
+    QString sha1;
+    QString crc32; // Full-file CRC32, unlike the header CRC1/CRC2
     QString filePath;
+    QString memberName; // ROM inside the archive at filePath; empty for plain ROM files
     QString cartID;
     QString mediaType;
     QString cartridgeCode;  // Changed from productID
-    QString cicChip;
+    CICChip cicChip = CIC_UNKNOWN;
     QString status;
-    QIcon icon;
-    bool isGoodDump;
-    bool forceFeedback; // Added Force Feedback field
+    bool headerParsed = false; // False for files that could not be parsed as a ROM
+    bool isGoodDump = false; // Boot checksum matches the header; unverified until checksumChecked
+    bool checksumChecked = false;
+    bool isVerifiedDump = false; // Full-ROM hash matches a verified rom_hashes entry
+    bool forceFeedback = false; // Added Force Feedback field
     
     // Additional flags for sorting/filtering
-    bool hasBeenPlayed;
+    bool hasBeenPlayed = false;
     QDateTime lastPlayed;
-    int playCount;
+    int playCount = 0;
     
     // Cover art information
     QString coverPath;
-    bool hasCover;
+    bool hasCover = false;
+    
+    // Identifies the ROM in the library; an archive holding several ROMs has one entry per member
+    QString key() const { return RomInfoProvider::romKey(filePath, memberName); }
 };
 
 /**
@@ -99,17 +112,21 @@ public:
     
     // ROM management methods
     bool addRom(const QString& filePath);
-    bool removeRom(const QString& filePath);
+    int appendRoms(const QVector<RomInfo>& roms);
+    bool removeRom(const QString& romKey);
     void clear();
     void refresh();
     
-    // Directory scanning
+    // Directory scanning (runs in the background, see RomScanner)
     void scanDirectory(const QString& path, bool recursive = false);
+    void cancelScan();
+    bool isScanning() const;
     
     // Access methods
     RomInfo getRomInfo(int index) const;
-    RomInfo getRomInfo(const QString& filePath) const;
+    RomInfo getRomInfo(const QString& romKey) const;
     QString getRomPath(int index) const;
+    const RomStore& romStore() const { return m_roms; }
     
     // Column visibility and order
     void setVisibleColumns(const QVector<RomColumns>& columns);
@@ -141,16 +158,21 @@ signals:
     void scanStarted();
     void scanProgress(int current, int total);
     void scanFinished();
-    void romAdded(const QString& filePath);
-    void romRemoved(const QString& filePath);
+    void romAdded(const QString& romKey);
+    void romRemoved(const QString& romKey);
     void coverLoaded(const QString& romPath);
     void columnsChanged();  // Add this signal
     
 private:
+    friend class RomScanner;
+    
     // Helper methods
     QIcon getCountryIcon(const QString& countryCode) const;
-    QString sizeToString(qint64 size) const;
-    bool findAndLoadCoverArt(const QString& romPath, RomInfo& info);
+    static QString sizeToString(qint64 size);
+    static QString crcToString(quint32 crc);
+    static QString cicChipToString(CICChip cicChip);
+    static QString releaseDateToString(const QString& releaseDate);
+    static bool findAndLoadCoverArt(const QString& romPath, const QString& coverDirectory, RomInfo& info);
     QPixmap createPlaceholderCover(const RomInfo& info) const;
     void loadSettings();
     void saveSettings();
@@ -158,14 +180,31 @@ private:
     void setDefaultColumns();
     void debugPrintColumns() const;  // Add this declaration
     
-    // ROM information loading
-    bool loadRomInfo(const QString& filePath, RomInfo& info);
+    // A file to load; the size comes from the directory listing, -1 if unknown
+    struct RomFile {
+        QString path;
+        qint64 size = -1;
+    };
     
-    // Data storage
-    QVector<RomInfo> m_romList;
-    QMap<QString, int> m_pathToIndex;
+    // ROM information loading (thread-safe, called from scan workers); only
+    // the boot area of each ROM is read, and archives yield one RomInfo per
+    // ROM member. Files that cannot be opened are left out.
+    static QVector<RomInfo> loadRomInfos(const QVector<RomFile>& files, const QString& coverDirectory);
+    static void fillRomInfo(const QString& filePath, qint64 fileSize, const RomInfoProvider* provider,
+                            const QString& coverDirectory, RomInfo& info);
+    
+    // Background boot checksum check of every ROM, plus MD5/SHA-1 hashing
+    // while the MD5 column is visible
+    void hashUnhashedRoms(int first, int last);
+    void applyHashResults(const QVector<RomHashResult>& results);
+    
+    // Data storage; values are formatted for display in data()
+    RomStore m_roms;
+    QMap<QString, int> m_pathToIndex; // By RomInfo::key()
     QVector<RomColumns> m_visibleColumns;
     QString m_currentDirectory;
+    RomScanner* m_scanner;
+    RomHasher* m_hasher;
     
     // Icon cache
     QMap<QString, QIcon> m_countryIcons;
@@ -0,0 +1,284 @@
+#include "RomScanner.h"
+#include "RomHashCache.h"
+#include <Core/SevenZipIndex.h>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QDebug>
+
+namespace QT_UI {
+
+// Results are handed to the model in batches at this interval, so views
+// re-sort and re-filter a few times per second instead of once per ROM
+const int RESULT_FLUSH_INTERVAL_MS = 150;
+
+// Files that miss the library cache are parsed in groups of this size, so each
+// group is resolved against the ROM database with one batch query
+const int PARSE_BATCH_SIZE = 32;
+
+/**
+ * Shared between the scanner and its pool tasks. A new state is created for
+ * each scan, so results of an older scan can be recognized and dropped on
+ * the GUI thread.
+ */
+struct RomScanner::ScanState {
+    QString path;
+    bool recursive = false;
+    QString coverDirectory;
+    QString coverStamp;
+    QAtomicInt cancelled { 0 };
+    QAtomicInt processed { 0 };
+    QAtomicInt discovered { 0 };
+    QAtomicInt enumerating { 1 };
+    QAtomicInt pending { 1 }; // Starts at 1 for the enumeration task
+    int previousTotal = 0;    // File count of the last scan of the same path
+
+    QMutex resultsMutex;
+    QVector<RomInfo> results; // Parsed ROMs not yet handed to the model
+
+    // Progress total: exact once enumeration is done, otherwise an estimate
+    // that only grows as more files are discovered
+    int estimatedTotal() const
+    {
+        int found = discovered.loadRelaxed();
+        if (!enumerating.loadRelaxed())
+            return found;
+        return qMax(found + 1, previousTotal);
+    }
+};
+
+RomScanner::RomScanner(QObject* parent)
+    : QObject(parent)
+    , m_lastProgress(-1)
+{
+    // Parsing is mostly I/O and SQLite bound; keep at least two workers so
+    // enumeration never starves the parsing tasks on small machines
+    m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+
+    m_flushTimer.setInterval(RESULT_FLUSH_INTERVAL_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &RomScanner::flushResults);
+}
+
+RomScanner::~RomScanner()
+{
+    if (m_state) {
+        m_state->cancelled.storeRelaxed(1);
+        m_state.reset();
+    }
+
+    // Tasks capture 'this', so they must be gone before we are
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    // Hash results may have arrived after the last scan saved
+    m_cache.save();
+}
+
+QStringList RomScanner::romFileFilters()
+{
+    return QStringList() << "*.z64" << "*.v64" << "*.n64" << "*.zip" << "*.7z";
+}
+
+void RomScanner::start(const QString& path, bool recursive, const QString& coverDirectory)
+{
+    // Silently abandon the previous scan; its late results are filtered by state
+    if (m_state) {
+        m_state->cancelled.storeRelaxed(1);
+        m_pool.clear();
+    }
+
+    auto state = std::make_shared<ScanState>();
+    state->path = QDir::cleanPath(path);
+    state->recursive = recursive;
+    state->coverDirectory = coverDirectory;
+    state->previousTotal = m_lastTotals.value(state->path, 0);
+    m_state = state;
+    m_lastProgress = -1;
+    m_flushTimer.start();
+
+    m_pool.start([this, state]() { enumerate(state); });
+}
+
+void RomScanner::cancel()
+{
+    if (!m_state)
+        return;
+
+    m_state->cancelled.storeRelaxed(1);
+    m_state.reset();
+    m_pool.clear();
+    m_flushTimer.stop();
+
+    emit finished(true);
+}
+
+bool RomScanner::isRunning() const
+{
+    return m_state != nullptr;
+}
+
+void RomScanner::updateHashes(const QVector<RomInfo>& roms)
+{
+    m_cache.updateHashes(roms);
+}
+
+void RomScanner::enumerate(std::shared_ptr<ScanState> state)
+{
+    m_cache.load();
+    state->coverStamp = RomLibraryCache::coverDirectoryStamp(state->coverDirectory);
+
+    // Single pass: files are queued for parsing in batches while the walk goes on, so
+    // parsing overlaps with directory listing (slow on cold caches and NAS mounts)
+    QSet<QString> seenPaths;
+    QVector<PendingFile> batch;
+    QDirIterator it(state->path, romFileFilters(), QDir::Files,
+                    state->recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext() && !state->cancelled.loadRelaxed()) {
+        QString filePath = it.next();
+        QFileInfo fileInfo = it.fileInfo();
+        qint64 size = fileInfo.size();
+        qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        seenPaths.insert(filePath);
+        state->discovered.ref();
+
+        // Unchanged files are served from the library cache without touching their contents
+        QVector<RomInfo> roms;
+        QString coverStamp;
+        if (m_cache.lookup(filePath, size, modified, roms, coverStamp)) {
+            if (coverStamp != state->coverStamp) {
+                for (RomInfo& info : roms) {
+                    info.hasCover = RomListModel::findAndLoadCoverArt(info.key(), state->coverDirectory, info);
+                }
+                m_cache.insert(filePath, roms, size, modified, state->coverStamp);
+            }
+            publishResults(state, roms);
+            continue;
+        }
+
+        batch.append({ filePath, size, modified });
+        if (batch.size() >= PARSE_BATCH_SIZE) {
+            startBatch(state, batch);
+            batch.clear();
+        }
+    }
+
+    if (!batch.isEmpty() && !state->cancelled.loadRelaxed()) {
+        startBatch(state, batch);
+    }
+
+    state->enumerating.storeRelaxed(0);
+
+    if (!state->cancelled.loadRelaxed()) {
+        m_cache.prune(state->path, state->recursive, seenPaths);
+        SevenZipIndex::instance().prune(state->path, state->recursive, seenPaths);
+        RomHashCache::instance().prune(state->path, state->recursive, seenPaths);
+    }
+
+    finishTask(state);
+}
+
+void RomScanner::startBatch(const std::shared_ptr<ScanState>& state, const QVector<PendingFile>& batch)
+{
+    state->pending.ref();
+    m_pool.start([this, state, batch]() { processFiles(state, batch); });
+}
+
+void RomScanner::processFiles(std::shared_ptr<ScanState> state, const QVector<PendingFile>& batch)
+{
+    if (!state->cancelled.loadRelaxed()) {
+        // Sizes from the directory walk spare the parser a stat per file
+        QVector<RomListModel::RomFile> files;
+        files.reserve(batch.size());
+        for (const PendingFile& file : batch) {
+            files.append(RomListModel::RomFile{ file.path, file.size });
+        }
+
+        // Archives yield one record per ROM member; group them by file again
+        QHash<QString, QVector<RomInfo>> romsByPath;
+        for (const RomInfo& info : RomListModel::loadRomInfos(files, state->coverDirectory)) {
+            romsByPath[info.filePath].append(info);
+        }
+
+        for (const PendingFile& file : batch) {
+            auto it = romsByPath.constFind(file.path);
+            if (it == romsByPath.cend()) {
+                state->processed.ref(); // Vanished or became unreadable; still counts as processed
+                continue;
+            }
+            m_cache.insert(file.path, *it, file.size, file.modified, state->coverStamp);
+            publishResults(state, *it);
+        }
+    }
+
+    finishTask(state);
+}
+
+void RomScanner::publishResults(const std::shared_ptr<ScanState>& state, const QVector<RomInfo>& roms)
+{
+    if (state->cancelled.loadRelaxed())
+        return;
+
+    {
+        QMutexLocker locker(&state->resultsMutex);
+        state->results.append(roms);
+    }
+    state->processed.ref();
+}
+
+void RomScanner::flushResults()
+{
+    if (!m_state)
+        return;
+
+    QVector<RomInfo> batch;
+    {
+        QMutexLocker locker(&m_state->resultsMutex);
+        batch.swap(m_state->results);
+    }
+
+    if (!batch.isEmpty()) {
+        emit romsScanned(batch);
+    }
+
+    int current = m_state->processed.loadRelaxed();
+    if (current != m_lastProgress) {
+        m_lastProgress = current;
+        emit progress(current, qMax(current, m_state->estimatedTotal()));
+    }
+}
+
+void RomScanner::finishTask(std::shared_ptr<ScanState> state)
+{
+    // The last task to finish reports completion; queued after its own results
+    if (!state->pending.deref()) {
+        QMetaObject::invokeMethod(this, [this, state]() {
+            if (state != m_state)
+                return;
+
+            // Hand over whatever arrived since the last tick
+            flushResults();
+            m_flushTimer.stop();
+            m_lastTotals.insert(state->path, state->discovered.loadRelaxed());
+            m_state.reset();
+
+            // Persist newly parsed ROMs, indexed archives and pruned hashes off
+            // the GUI thread
+            m_pool.start([this]() {
+                m_cache.save();
+                SevenZipIndex::instance().save();
+                RomHashCache::instance().save();
+            });
+
+            emit finished(false);
+        }, Qt::QueuedConnection);
+    }
+}
+
+} // namespace QT_UI
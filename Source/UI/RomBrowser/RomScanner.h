@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <QHash>
+#include <memory>
+
+#include "RomListModel.h"
+#include "RomLibraryCache.h"
+
+namespace QT_UI {
+
+/**
+ * @brief Background ROM directory scanner
+ *
+ * Walks a ROM directory once, off the GUI thread, queueing discovered files
+ * on a worker pool in small batches; each batch is header-parsed and then
+ * resolved against the ROM database with a single query. The progress total
+ * is an estimate that grows while the walk is still running. Results are
+ * collected from the workers and handed to the owning thread in time-sliced
+ * batches, so all signals of this class are emitted on the thread the
+ * scanner lives in.
+ *
+ * ZIP and 7z archives are listed from their directories, without being
+ * extracted, and every ROM member becomes an entry of its own.
+ *
+ * Files whose size and modification time match the persistent
+ * RomLibraryCache are served from it without being opened.
+ */
+class RomScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RomScanner(QObject* parent = nullptr);
+    ~RomScanner();
+
+    /**
+     * @brief Starts scanning a directory, cancelling any scan in progress
+     * @param path Directory to scan
+     * @param recursive Whether to descend into subdirectories
+     * @param coverDirectory Directory used to resolve cover art
+     */
+    void start(const QString& path, bool recursive, const QString& coverDirectory);
+
+    /**
+     * @brief Cancels the current scan; results still in flight are discarded
+     */
+    void cancel();
+
+    /**
+     * @brief Gets whether a scan is in progress
+     * @return True while a scan is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Records hashes and boot checksum results in the library cache,
+     *        so the next scan restores them instead of checking again
+     */
+    void updateHashes(const QVector<RomInfo>& roms);
+
+    /**
+     * @brief File name filters for ROM files picked up by the scanner
+     */
+    static QStringList romFileFilters();
+
+signals:
+    void romsScanned(const QVector<QT_UI::RomInfo>& roms);
+    void progress(int current, int total);
+    void finished(bool cancelled);
+
+private slots:
+    void flushResults();
+
+private:
+    struct ScanState;
+
+    // A file that missed the library cache, with the stat data it was found with
+    struct PendingFile {
+        QString path;
+        qint64 size;
+        qint64 modified;
+    };
+
+    void enumerate(std::shared_ptr<ScanState> state);
+    void startBatch(const std::shared_ptr<ScanState>& state, const QVector<PendingFile>& batch);
+    void processFiles(std::shared_ptr<ScanState> state, const QVector<PendingFile>& batch);
+    // Hands over the ROMs of one file; progress counts files, not ROMs
+    void publishResults(const std::shared_ptr<ScanState>& state, const QVector<RomInfo>& roms);
+    void finishTask(std::shared_ptr<ScanState> state);
+
+    RomLibraryCache m_cache;
+    QThreadPool m_pool;
+    std::shared_ptr<ScanState> m_state;
+    QTimer m_flushTimer;
+    int m_lastProgress;
+    QHash<QString, int> m_lastTotals; // Seeds the progress estimate on rescans
+};
+
+} // namespace QT_UI
@@ -0,0 +1,190 @@
+#include "RomSearchIndex.h"
+#include "RomStore.h"
+#include <algorithm>
+#include <iterator>
+
+namespace QT_UI {
+
+static const int TRIGRAM_LENGTH = 3;
+
+// Rows handled between checks for cancellation
+static const int CANCEL_CHECK_INTERVAL = 1024;
+
+quint64 RomSearchIndex::trigram(const QChar* chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | chars[2].unicode();
+}
+
+bool RomSearchIndex::isCancelled(const QAtomicInt* cancelled, int step)
+{
+    return cancelled && step % CANCEL_CHECK_INTERVAL == 0 && cancelled->loadRelaxed();
+}
+
+void RomSearchIndex::append(const RomStore& roms, int first, int last, const QAtomicInt* cancelled)
+{
+    QVector<quint64> trigrams;
+    for (int row = first; row <= last; ++row) {
+        if (isCancelled(cancelled, row - first))
+            return;
+
+        // Fields go on separate lines, so no term can match across two of them
+        const QString text = QStringList({
+            roms.goodName(row),
+            roms.internalName(row),
+            roms.fileName(row),
+            roms.cartridgeCode(row),
+            roms.developer(row)
+        }).join('\n').toCaseFolded();
+
+        trigrams.clear();
+        for (int i = 0; i + TRIGRAM_LENGTH <= text.size(); ++i) {
+            trigrams.append(trigram(text.constData() + i));
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        const int indexRow = m_text.size();
+        for (quint64 key : trigrams) {
+            m_postings[key].append(indexRow);
+        }
+        m_text.append(text);
+    }
+}
+
+void RomSearchIndex::removeRows(int first, int count)
+{
+    const int last = first + count - 1;
+    m_text.remove(first, count);
+
+    for (auto it = m_postings.begin(); it != m_postings.end();) {
+        QVector<int>& rows = it.value();
+        auto removeBegin = std::lower_bound(rows.begin(), rows.end(), first);
+        auto removeEnd = std::upper_bound(removeBegin, rows.end(), last);
+        for (auto shift = removeEnd; shift != rows.end(); ++shift) {
+            *shift -= count;
+        }
+        rows.erase(removeBegin, removeEnd);
+
+        if (rows.isEmpty()) {
+            it = m_postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RomSearchIndex::clear()
+{
+    m_text.clear();
+    m_postings.clear();
+}
+
+QStringList RomSearchIndex::terms(const QString& query)
+{
+    QStringList terms = query.toCaseFolded().simplified().split(' ', Qt::SkipEmptyParts);
+    terms.removeDuplicates();
+    return terms;
+}
+
+bool RomSearchIndex::narrows(const QStringList& oldTerms, const QStringList& newTerms)
+{
+    if (oldTerms.isEmpty())
+        return false;
+
+    // A row holding every new term holds each old term that is part of one
+    for (const QString& oldTerm : oldTerms) {
+        const bool covered = std::any_of(newTerms.cbegin(), newTerms.cend(),
+                                         [&oldTerm](const QString& newTerm) { return newTerm.contains(oldTerm); });
+        if (!covered)
+            return false;
+    }
+    return true;
+}
+
+bool RomSearchIndex::matches(int row, const QStringList& terms) const
+{
+    const QString& text = m_text.at(row);
+    for (const QString& term : terms) {
+        if (!text.contains(term))
+            return false;
+    }
+    return true;
+}
+
+const QVector<int>* RomSearchIndex::rarestPostings(const QStringList& terms, bool& noMatch) const
+{
+    const QVector<int>* rarest = nullptr;
+    noMatch = false;
+
+    for (const QString& term : terms) {
+        for (int i = 0; i + TRIGRAM_LENGTH <= term.size(); ++i) {
+            auto it = m_postings.constFind(trigram(term.constData() + i));
+            if (it == m_postings.cend()) {
+                noMatch = true;
+                return nullptr;
+            }
+            if (!rarest || it.value().size() < rarest->size()) {
+                rarest = &it.value();
+            }
+        }
+    }
+    return rarest;
+}
+
+QVector<int> RomSearchIndex::search(const QStringList& terms, const QAtomicInt* cancelled) const
+{
+    QVector<int> result;
+
+    bool noMatch = false;
+    const QVector<int>* candidates = rarestPostings(terms, noMatch);
+    if (noMatch)
+        return result;
+
+    if (candidates) {
+        for (int i = 0; i < candidates->size(); ++i) {
+            if (isCancelled(cancelled, i))
+                break;
+            if (matches(candidates->at(i), terms))
+                result.append(candidates->at(i));
+        }
+    } else {
+        // Only terms shorter than a trigram; scan everything
+        for (int row = 0; row < m_text.size(); ++row) {
+            if (isCancelled(cancelled, row))
+                break;
+            if (matches(row, terms))
+                result.append(row);
+        }
+    }
+    return result;
+}
+
+QVector<int> RomSearchIndex::refine(const QVector<int>& rows, const QStringList& terms,
+                                    const QAtomicInt* cancelled) const
+{
+    QVector<int> result;
+
+    bool noMatch = false;
+    const QVector<int>* postings = rarestPostings(terms, noMatch);
+    if (noMatch)
+        return result;
+
+    // Both lists are ascending; only verify the rows they share
+    QVector<int> candidates;
+    const QVector<int>* toVerify = &rows;
+    if (postings && postings->size() < rows.size()) {
+        std::set_intersection(rows.cbegin(), rows.cend(), postings->cbegin(), postings->cend(),
+                              std::back_inserter(candidates));
+        toVerify = &candidates;
+    }
+
+    for (int i = 0; i < toVerify->size(); ++i) {
+        if (isCancelled(cancelled, i))
+            break;
+        if (matches(toVerify->at(i), terms))
+            result.append(toVerify->at(i));
+    }
+    return result;
+}
+
+} // namespace QT_UI
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace QT_UI {
+
+class RomStore;
+
+/**
+ * @brief Trigram index for the ROM browser search box
+ *
+ * Indexes the good name, internal name, file name, cartridge code and
+ * developer of each row. Every search term (queries are split on whitespace)
+ * must occur case-insensitively in one of those fields. Terms of three or
+ * more characters are looked up through the posting list of their rarest
+ * trigram and only those candidates are verified; shorter terms fall back to
+ * scanning the folded text.
+ *
+ * Rows are appended at the end, like in RomStore; removeRows() drops a range
+ * and renumbers the rows after it, so row numbers keep matching the source
+ * model. The index is a value type built on implicitly shared containers, so
+ * copies are cheap and a copy can be extended and searched on a worker
+ * thread. Building and searching stop early, with a partial result, once
+ * *cancelled is set.
+ */
+class RomSearchIndex
+{
+public:
+    int size() const { return m_text.size(); }
+    void append(const RomStore& roms, int first, int last, const QAtomicInt* cancelled = nullptr);
+    void removeRows(int first, int count);
+    void clear();
+
+    /**
+     * @brief Splits a query into case-folded search terms
+     */
+    static QStringList terms(const QString& query);
+
+    /**
+     * @brief Gets whether every row matching the new terms also matched the
+     *        old ones, so a search for them can be refined from the old result
+     */
+    static bool narrows(const QStringList& oldTerms, const QStringList& newTerms);
+
+    bool matches(int row, const QStringList& terms) const;
+
+    /**
+     * @brief Gets the matching rows, in ascending order
+     */
+    QVector<int> search(const QStringList& terms, const QAtomicInt* cancelled = nullptr) const;
+
+    /**
+     * @brief Gets the rows among the given ones that match
+     */
+    QVector<int> refine(const QVector<int>& rows, const QStringList& terms,
+                        const QAtomicInt* cancelled = nullptr) const;
+
+private:
+    static quint64 trigram(const QChar* chars);
+    static bool isCancelled(const QAtomicInt* cancelled, int step);
+    const QVector<int>* rarestPostings(const QStringList& terms, bool& noMatch) const;
+
+    QVector<QString> m_text;                 // Folded fields, one per line
+    QHash<quint64, QVector<int>> m_postings; // Trigram -> ascending rows
+};
+
+} // namespace QT_UI
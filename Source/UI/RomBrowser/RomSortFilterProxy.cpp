@@ -0,0 +1,732 @@
+#include "RomSortFilterProxy.h"
+#include <Core/StringPool.h>
+#include <QDate>
+#include <QMetaObject>
+#include <QStringList>
+#include <algorithm>
+#include <limits>
+
+namespace QT_UI {
+
+// Typing pause before a search starts; keystrokes within it restart the wait
+static const int SEARCH_DEBOUNCE_MS = 120;
+
+// Unknown values sort before all known ones
+static const qint64 UNKNOWN_KEY = std::numeric_limits<qint64>::min();
+
+// Days since the epoch of a YYYY-MM-DD, YYYY-MM or YYYY release date
+static qint64 releaseDay(const QString& releaseDate)
+{
+    const QStringList parts = releaseDate.split('-');
+    bool yearOk = false, monthOk = true, dayOk = true;
+    const int year = parts.at(0).toInt(&yearOk);
+    const int month = parts.size() > 1 ? parts.at(1).toInt(&monthOk) : 1;
+    const int day = parts.size() > 2 ? parts.at(2).toInt(&dayOk) : 1;
+
+    const QDate date(year, month, day);
+    if (!yearOk || !monthOk || !dayOk || !date.isValid())
+        return UNKNOWN_KEY;
+    return date.toJulianDay();
+}
+
+/**
+ * A search running on the worker: the source rows, index and shown rows as of
+ * its start, and its result. Replaced when a newer search starts, so results
+ * of stale searches can be recognized on the owning thread.
+ */
+struct RomSortFilterProxy::SearchState {
+    QAtomicInt cancelled { 0 };
+    quint64 generation = 0;   // Source generation the snapshot was taken from
+    QStringList terms;
+    RomStore roms;            // Implicitly shared snapshot of the source rows
+    RomSearchIndex index;     // Extended to all snapshot rows by the worker
+    QVector<bool> shown;      // Accepted rows to refine, empty for a full search
+    QVector<int> matches;
+};
+
+RomSortFilterProxy::RomSortFilterProxy(QObject* parent)
+    : QAbstractProxyModel(parent)
+    , m_sortColumn(-1)
+    , m_sortOrder(Qt::AscendingOrder)
+    , m_sortField(-1)
+    , m_keyType(NumberKey)
+    , m_sourceGeneration(0)
+    , m_searchOutdated(false)
+    , m_sourceToProxyDirty(true)
+{
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_collator.setNumericMode(true);
+
+    // One search at a time; a stale one stops at its next cancellation check
+    m_searchPool.setMaxThreadCount(1);
+
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(SEARCH_DEBOUNCE_MS);
+    connect(&m_searchTimer, &QTimer::timeout, this, &RomSortFilterProxy::startSearch);
+}
+
+RomSortFilterProxy::~RomSortFilterProxy()
+{
+    cancelSearch();
+
+    // Tasks capture 'this', so they must be gone before we are
+    m_searchPool.waitForDone();
+}
+
+void RomSortFilterProxy::setSourceModel(QAbstractItemModel* sourceModel)
+{
+    Q_ASSERT(!sourceModel || qobject_cast<RomListModel*>(sourceModel));
+
+    beginResetModel();
+
+    if (QAbstractItemModel* oldModel = this->sourceModel()) {
+        disconnect(oldModel, nullptr, this, nullptr);
+    }
+
+    QAbstractProxyModel::setSourceModel(sourceModel);
+
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &RomSortFilterProxy::onSourceAboutToBeReset);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &RomSortFilterProxy::onSourceReset);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &RomSortFilterProxy::onRowsInserted);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &RomSortFilterProxy::onRowsAboutToBeRemoved);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &RomSortFilterProxy::onRowsRemoved);
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &RomSortFilterProxy::onDataChanged);
+        connect(sourceModel, &QAbstractItemModel::headerDataChanged, this, &QAbstractItemModel::headerDataChanged);
+    }
+
+    // Ends the reset begun above
+    onSourceReset();
+}
+
+RomListModel* RomSortFilterProxy::romModel() const
+{
+    return static_cast<RomListModel*>(sourceModel());
+}
+
+QModelIndex RomSortFilterProxy::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex RomSortFilterProxy::parent(const QModelIndex& child) const
+{
+    Q_UNUSED(child);
+    return QModelIndex();
+}
+
+int RomSortFilterProxy::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
+}
+
+int RomSortFilterProxy::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return sourceModel()->columnCount();
+}
+
+QVariant RomSortFilterProxy::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    // Columns are passed through unchanged, so headers need no row to map through
+    if (orientation == Qt::Horizontal && sourceModel())
+        return sourceModel()->headerData(section, orientation, role);
+    return QVariant();
+}
+
+QModelIndex RomSortFilterProxy::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel() || proxyIndex.row() >= m_rows.size())
+        return QModelIndex();
+    return sourceModel()->index(m_rows.at(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex RomSortFilterProxy::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+
+    rebuildSourceToProxy();
+    const int proxyRow = m_sourceToProxy.value(sourceIndex.row(), -1);
+    if (proxyRow < 0)
+        return QModelIndex();
+    return createIndex(proxyRow, sourceIndex.column());
+}
+
+void RomSortFilterProxy::sort(int column, Qt::SortOrder order)
+{
+    if (column == m_sortColumn && order == m_sortOrder)
+        return;
+
+    beginLayoutChange();
+    m_sortColumn = column;
+    m_sortOrder = order;
+    updateSortField();
+    computeKeys();
+    sortOrder();
+    endLayoutChange();
+}
+
+void RomSortFilterProxy::setSearchText(const QString& text)
+{
+    const QStringList terms = RomSearchIndex::terms(text);
+    if (terms == m_pendingTerms)
+        return;
+
+    m_pendingTerms = terms;
+    cancelSearch();
+    m_searchTimer.stop();
+
+    if (m_pendingTerms.isEmpty()) {
+        // Showing everything needs no search
+        if (!m_searchTerms.isEmpty()) {
+            beginLayoutChange();
+            m_searchTerms.clear();
+            m_searchOutdated = false;
+            m_accepted.fill(true);
+            endLayoutChange();
+        }
+    } else if (m_pendingTerms != m_searchTerms || m_searchOutdated) {
+        m_searchTimer.start();
+    }
+}
+
+void RomSortFilterProxy::startSearch()
+{
+    cancelSearch();
+    if (m_pendingTerms.isEmpty() || (m_pendingTerms == m_searchTerms && !m_searchOutdated) || !sourceModel())
+        return;
+
+    std::shared_ptr<SearchState> state = std::make_shared<SearchState>();
+    state->generation = m_sourceGeneration;
+    state->terms = m_pendingTerms;
+    state->roms = romModel()->romStore();
+    state->index = m_searchIndex;
+
+    // Typing on only narrows the result, so search within the rows shown
+    if (!m_searchOutdated && RomSearchIndex::narrows(m_searchTerms, m_pendingTerms)) {
+        state->shown = m_accepted;
+    }
+
+    m_searchState = state;
+    m_searchPool.start([this, state]() { searchTask(state); });
+}
+
+void RomSortFilterProxy::cancelSearch()
+{
+    if (!m_searchState)
+        return;
+
+    m_searchState->cancelled.storeRelaxed(1);
+    m_searchState.reset();
+    m_searchPool.clear();
+}
+
+void RomSortFilterProxy::searchTask(std::shared_ptr<SearchState> state)
+{
+    // The index is built by the first search and caught up by later ones
+    const int count = state->roms.size();
+    state->index.append(state->roms, state->index.size(), count - 1, &state->cancelled);
+    state->roms = RomStore();
+
+    if (state->shown.isEmpty()) {
+        state->matches = state->index.search(state->terms, &state->cancelled);
+    } else {
+        QVector<int> shownRows;
+        for (int row = 0; row < state->shown.size(); ++row) {
+            if (state->shown.at(row))
+                shownRows.append(row);
+        }
+        state->matches = state->index.refine(shownRows, state->terms, &state->cancelled);
+    }
+
+    if (state->cancelled.loadRelaxed())
+        return;
+
+    QMetaObject::invokeMethod(this, [this, state]() { publishSearch(state); }, Qt::QueuedConnection);
+}
+
+void RomSortFilterProxy::publishSearch(std::shared_ptr<SearchState> state)
+{
+    if (state != m_searchState)
+        return;
+    m_searchState.reset();
+
+    // Rows were removed or reset meanwhile; the result no longer lines up
+    if (state->generation != m_sourceGeneration) {
+        startSearch();
+        return;
+    }
+
+    // Rows appended since the snapshot are matched here, against the adopted index
+    const int searchedRows = state->index.size();
+    m_searchIndex = state->index;
+    m_searchTerms = state->terms;
+    m_searchOutdated = false;
+    updateSearchIndex();
+
+    QVector<bool> accepted(m_accepted.size(), false);
+    for (int row : state->matches) {
+        accepted[row] = true;
+    }
+    for (int row = searchedRows; row < accepted.size(); ++row) {
+        accepted[row] = acceptsRow(row);
+    }
+
+    // Swap in the new result as one layout change
+    beginLayoutChange();
+    m_accepted.swap(accepted);
+    endLayoutChange();
+}
+
+void RomSortFilterProxy::onSourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void RomSortFilterProxy::onSourceReset()
+{
+    // Visible columns may have changed; keep sorting by the same view column
+    const int count = sourceModel() ? sourceModel()->rowCount() : 0;
+    updateSortField();
+    computeKeys();
+
+    // An active search stays in effect: no rows are shown until it has run
+    // over the new rows and its result is swapped in
+    ++m_sourceGeneration;
+    m_searchIndex.clear();
+    m_searchOutdated = !m_searchTerms.isEmpty();
+
+    m_order.resize(count);
+    m_accepted.resize(count);
+    for (int row = 0; row < count; ++row) {
+        m_order[row] = row;
+        m_accepted[row] = acceptsRow(row);
+    }
+    sortOrder();
+    rebuildRows();
+
+    endResetModel();
+
+    if (m_searchOutdated) {
+        m_searchTimer.stop();
+        startSearch();
+    }
+}
+
+void RomSortFilterProxy::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    // RomListModel only appends; anything else is handled as a reset
+    if (first != m_accepted.size()) {
+        beginResetModel();
+        onSourceReset();
+        return;
+    }
+
+    updateSearchIndex();
+
+    const int count = last - first + 1;
+    QVector<int> newRows;
+    newRows.reserve(count);
+    for (int row = first; row <= last; ++row) {
+        m_accepted.append(acceptsRow(row));
+        newRows.append(row);
+    }
+
+    if (m_sortField < 0) {
+        // Source order: accepted rows go to the end as one contiguous block
+        QVector<int> acceptedRows;
+        for (int row : newRows) {
+            if (m_accepted.at(row))
+                acceptedRows.append(row);
+        }
+        m_order += newRows;
+
+        if (!acceptedRows.isEmpty()) {
+            beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + acceptedRows.size() - 1);
+            m_rows += acceptedRows;
+            m_sourceToProxyDirty = true;
+            endInsertRows();
+        }
+        return;
+    }
+
+    beginLayoutChange();
+    if (appendKeys(first, last)) {
+        // Sort the new batch on its own and merge it in: O(n) instead of a full sort
+        auto less = [this](int left, int right) { return lessThan(left, right); };
+        std::sort(newRows.begin(), newRows.end(), less);
+        const int middle = m_order.size();
+        m_order += newRows;
+        std::inplace_merge(m_order.begin(), m_order.begin() + middle, m_order.end(), less);
+    } else {
+        // A new value changed the ranks of existing ones
+        m_order += newRows;
+        computeKeys();
+        sortOrder();
+    }
+    endLayoutChange();
+}
+
+void RomSortFilterProxy::onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    Q_UNUSED(first);
+    Q_UNUSED(last);
+    if (parent.isValid())
+        return;
+
+    beginLayoutChange();
+}
+
+void RomSortFilterProxy::onRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    // Drop the removed rows and renumber the ones after them
+    const int count = last - first + 1;
+    auto renumber = [first, last, count](int row) {
+        if (row < first)
+            return row;
+        return row > last ? row - count : -1;
+    };
+
+    QVector<int> order;
+    order.reserve(m_order.size() - count);
+    for (int row : m_order) {
+        const int newRow = renumber(row);
+        if (newRow >= 0)
+            order.append(newRow);
+    }
+    m_order.swap(order);
+    m_accepted.remove(first, count);
+
+    if (m_sortField < 0) {
+        // No keys
+    } else if (m_keyType == TextKey) {
+        m_textKeys.erase(m_textKeys.begin() + first, m_textKeys.begin() + last + 1);
+    } else {
+        m_numberKeys.remove(first, count);
+    }
+
+    ++m_sourceGeneration;
+    if (first < m_searchIndex.size()) {
+        m_searchIndex.removeRows(first, qMin(count, m_searchIndex.size() - first));
+    }
+
+    for (int& row : m_layoutSourceRows) {
+        if (row >= 0)
+            row = renumber(row);
+    }
+
+    endLayoutChange();
+}
+
+void RomSortFilterProxy::onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid())
+        return;
+
+    const int first = topLeft.row();
+    const int last = qMin(bottomRight.row(), m_accepted.size() - 1);
+
+    // Hash results and cover changes rarely touch the sort key or the first
+    // column, so only re-sort or re-filter when they did
+    bool layoutChanged = false;
+    for (int row = first; row <= last && !layoutChanged; ++row) {
+        if (acceptsRow(row) != m_accepted.at(row)) {
+            layoutChanged = true;
+        } else if (m_sortField >= 0) {
+            switch (m_keyType) {
+            case NumberKey:
+                layoutChanged = numberKey(row) != m_numberKeys.at(row);
+                break;
+            case RankKey:
+                layoutChanged = m_ranks.value(internedId(row), UNKNOWN_KEY) != m_numberKeys.at(row);
+                break;
+            case TextKey:
+                layoutChanged = m_collator.sortKey(textKey(row)).compare(m_textKeys[row]) != 0;
+                break;
+            }
+        }
+    }
+
+    if (layoutChanged) {
+        beginLayoutChange();
+        for (int row = first; row <= last; ++row) {
+            m_accepted[row] = acceptsRow(row);
+        }
+        computeKeys();
+        sortOrder();
+        endLayoutChange();
+    }
+
+    // Forward the change for the visible rows it covers
+    rebuildSourceToProxy();
+    int firstProxyRow = -1;
+    int lastProxyRow = -1;
+    for (int row = first; row <= last; ++row) {
+        const int proxyRow = m_sourceToProxy.value(row, -1);
+        if (proxyRow >= 0) {
+            firstProxyRow = firstProxyRow < 0 ? proxyRow : qMin(firstProxyRow, proxyRow);
+            lastProxyRow = qMax(lastProxyRow, proxyRow);
+        }
+    }
+    if (firstProxyRow >= 0) {
+        emit dataChanged(index(firstProxyRow, topLeft.column()), index(lastProxyRow, bottomRight.column()));
+    }
+}
+
+void RomSortFilterProxy::updateSortField()
+{
+    const QVector<RomListModel::RomColumns> columns = romModel() ? romModel()->visibleColumns()
+                                                                 : QVector<RomListModel::RomColumns>();
+    m_sortField = (m_sortColumn >= 0 && m_sortColumn < columns.size()) ? columns.at(m_sortColumn) : -1;
+
+    switch (m_sortField) {
+    case RomListModel::Size:
+    case RomListModel::ReleaseDate:
+    case RomListModel::Players:
+    case RomListModel::CRC1:
+    case RomListModel::CRC2:
+    case RomListModel::ForceFeedback:
+    case RomListModel::CICChip:
+        m_keyType = NumberKey;
+        break;
+    case RomListModel::Country:
+    case RomListModel::Genre:
+    case RomListModel::Developer:
+    case RomListModel::MediaType:
+    case RomListModel::Status:
+        m_keyType = RankKey;
+        break;
+    default:
+        m_keyType = TextKey;
+        break;
+    }
+}
+
+void RomSortFilterProxy::computeKeys()
+{
+    m_numberKeys.clear();
+    m_textKeys.clear();
+    m_ranks.clear();
+
+    if (m_sortField < 0 || !sourceModel())
+        return;
+
+    if (m_keyType == RankKey) {
+        computeRanks();
+    }
+    appendKeys(0, sourceModel()->rowCount() - 1);
+}
+
+bool RomSortFilterProxy::appendKeys(int first, int last)
+{
+    switch (m_keyType) {
+    case NumberKey:
+        for (int row = first; row <= last; ++row) {
+            m_numberKeys.append(numberKey(row));
+        }
+        return true;
+    case RankKey:
+        for (int row = first; row <= last; ++row) {
+            auto it = m_ranks.constFind(internedId(row));
+            if (it == m_ranks.cend())
+                return false;
+            m_numberKeys.append(it.value());
+        }
+        return true;
+    case TextKey:
+        m_textKeys.reserve(last + 1);
+        for (int row = first; row <= last; ++row) {
+            m_textKeys.push_back(m_collator.sortKey(textKey(row)));
+        }
+        return true;
+    }
+    return true;
+}
+
+void RomSortFilterProxy::computeRanks()
+{
+    // Interned columns hold a few hundred distinct values; collate those once
+    // and compare rows by rank
+    const int count = sourceModel()->rowCount();
+    QVector<quint32> ids;
+    QHash<quint32, qint64> seen;
+    for (int row = 0; row < count; ++row) {
+        const quint32 id = internedId(row);
+        if (!seen.contains(id)) {
+            seen.insert(id, 0);
+            ids.append(id);
+        }
+    }
+
+    const StringPool& pool = StringPool::instance();
+    std::sort(ids.begin(), ids.end(), [this, &pool](quint32 left, quint32 right) {
+        return m_collator.compare(pool.at(left), pool.at(right)) < 0;
+    });
+
+    for (int rank = 0; rank < ids.size(); ++rank) {
+        m_ranks.insert(ids.at(rank), rank);
+    }
+}
+
+qint64 RomSortFilterProxy::numberKey(int sourceRow) const
+{
+    const RomStore& roms = romModel()->romStore();
+    const bool headerParsed = roms.hasFlag(sourceRow, RomStore::HeaderParsed);
+
+    switch (m_sortField) {
+    case RomListModel::Size: return roms.romSize(sourceRow) >= 0 ? roms.romSize(sourceRow) : UNKNOWN_KEY;
+    case RomListModel::ReleaseDate: return releaseDay(roms.releaseDate(sourceRow));
+    case RomListModel::Players: return roms.players(sourceRow) > 0 ? roms.players(sourceRow) : UNKNOWN_KEY;
+    case RomListModel::CRC1: return headerParsed ? qint64(roms.crc1(sourceRow)) : UNKNOWN_KEY;
+    case RomListModel::CRC2: return headerParsed ? qint64(roms.crc2(sourceRow)) : UNKNOWN_KEY;
+    case RomListModel::ForceFeedback: return roms.hasFlag(sourceRow, RomStore::ForceFeedback) ? 1 : 0;
+    case RomListModel::CICChip: return headerParsed ? qint64(roms.cicChip(sourceRow)) : UNKNOWN_KEY;
+    default: return 0;
+    }
+}
+
+quint32 RomSortFilterProxy::internedId(int sourceRow) const
+{
+    const RomStore& roms = romModel()->romStore();
+
+    switch (m_sortField) {
+    case RomListModel::Country: return roms.countryId(sourceRow);
+    case RomListModel::Genre: return roms.genreId(sourceRow);
+    case RomListModel::Developer: return roms.developerId(sourceRow);
+    case RomListModel::MediaType: return roms.mediaTypeId(sourceRow);
+    case RomListModel::Status: return roms.statusId(sourceRow);
+    default: return 0;
+    }
+}
+
+QString RomSortFilterProxy::textKey(int sourceRow) const
+{
+    const RomStore& roms = romModel()->romStore();
+
+    switch (m_sortField) {
+    case RomListModel::FileName: return roms.fileName(sourceRow);
+    case RomListModel::GoodName: return roms.goodName(sourceRow);
+    case RomListModel::InternalName: return roms.internalName(sourceRow);
+    case RomListModel::MD5: return roms.md5(sourceRow);
+    case RomListModel::FilePath: return roms.filePath(sourceRow);
+    case RomListModel::CartID: return roms.cartID(sourceRow);
+    case RomListModel::CartridgeCode: return roms.cartridgeCode(sourceRow);
+    default: return QString();
+    }
+}
+
+bool RomSortFilterProxy::lessThan(int leftRow, int rightRow) const
+{
+    int result = 0;
+    if (m_keyType == TextKey) {
+        result = m_textKeys[leftRow].compare(m_textKeys[rightRow]);
+    } else {
+        const qint64 left = m_numberKeys.at(leftRow);
+        const qint64 right = m_numberKeys.at(rightRow);
+        result = left < right ? -1 : (left > right ? 1 : 0);
+    }
+
+    // Equal keys keep the source order, in either direction
+    if (result == 0)
+        return leftRow < rightRow;
+    return m_sortOrder == Qt::AscendingOrder ? result < 0 : result > 0;
+}
+
+void RomSortFilterProxy::sortOrder()
+{
+    if (m_sortField < 0) {
+        std::sort(m_order.begin(), m_order.end());
+        return;
+    }
+
+    std::sort(m_order.begin(), m_order.end(), [this](int left, int right) { return lessThan(left, right); });
+}
+
+void RomSortFilterProxy::updateSearchIndex()
+{
+    // Only needed to match appended rows while a search is shown; the worker
+    // catches the index up before each search otherwise
+    if (m_searchTerms.isEmpty() || m_searchOutdated)
+        return;
+
+    const int count = sourceModel() ? sourceModel()->rowCount() : 0;
+    if (m_searchIndex.size() < count) {
+        m_searchIndex.append(romModel()->romStore(), m_searchIndex.size(), count - 1);
+    }
+}
+
+bool RomSortFilterProxy::acceptsRow(int sourceRow) const
+{
+    if (m_searchOutdated)
+        return false;
+    return m_searchTerms.isEmpty() || m_searchIndex.matches(sourceRow, m_searchTerms);
+}
+
+void RomSortFilterProxy::beginLayoutChange()
+{
+    emit layoutAboutToBeChanged();
+
+    m_layoutIndexes = persistentIndexList();
+    m_layoutSourceRows.clear();
+    m_layoutSourceRows.reserve(m_layoutIndexes.size());
+    for (const QModelIndex& proxyIndex : m_layoutIndexes) {
+        m_layoutSourceRows.append(proxyIndex.row() < m_rows.size() ? m_rows.at(proxyIndex.row()) : -1);
+    }
+}
+
+void RomSortFilterProxy::endLayoutChange()
+{
+    rebuildRows();
+    rebuildSourceToProxy();
+
+    QModelIndexList updated;
+    updated.reserve(m_layoutIndexes.size());
+    for (int i = 0; i < m_layoutIndexes.size(); ++i) {
+        const int sourceRow = m_layoutSourceRows.at(i);
+        const int proxyRow = sourceRow >= 0 ? m_sourceToProxy.value(sourceRow, -1) : -1;
+        updated.append(proxyRow >= 0 ? createIndex(proxyRow, m_layoutIndexes.at(i).column()) : QModelIndex());
+    }
+    changePersistentIndexList(m_layoutIndexes, updated);
+
+    m_layoutIndexes.clear();
+    m_layoutSourceRows.clear();
+
+    emit layoutChanged();
+}
+
+void RomSortFilterProxy::rebuildRows()
+{
+    m_rows.clear();
+    m_rows.reserve(m_order.size());
+    for (int row : m_order) {
+        if (m_accepted.at(row))
+            m_rows.append(row);
+    }
+    m_sourceToProxyDirty = true;
+}
+
+void RomSortFilterProxy::rebuildSourceToProxy() const
+{
+    if (!m_sourceToProxyDirty)
+        return;
+
+    m_sourceToProxy.fill(-1, m_accepted.size());
+    for (int proxyRow = 0; proxyRow < m_rows.size(); ++proxyRow) {
+        m_sourceToProxy[m_rows.at(proxyRow)] = proxyRow;
+    }
+    m_sourceToProxyDirty = false;
+}
+
+} // namespace QT_UI
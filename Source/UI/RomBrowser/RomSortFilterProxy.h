@@ -0,0 +1,136 @@
+#pragma once
+
+#include <QAbstractProxyModel>
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "RomListModel.h"
+#include "RomSearchIndex.h"
+
+namespace QT_UI {
+
+/**
+ * @brief Sort/filter proxy for the ROM browser views
+ *
+ * Sorts on typed keys precomputed from the model's RomStore when the sort
+ * column changes, instead of fetching and comparing display strings per
+ * comparison: sizes, CRCs and release dates compare as integers, interned
+ * text (country, genre, ...) by the rank of its StringPool id, and names by
+ * collation keys (case-insensitive, numbers in numeric order).
+ *
+ * The sorted order of all source rows is kept between updates. Rows appended
+ * by a scan are sorted among themselves and merged into it, so a growing
+ * library is never re-sorted from scratch. Searches go through a
+ * RomSearchIndex on a worker thread once typing pauses; a newer keystroke
+ * cancels a search in progress, and a search that only narrows the previous
+ * one is run on its result. Sorting and searching publish the new order as a
+ * single layout change.
+ */
+class RomSortFilterProxy : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit RomSortFilterProxy(QObject* parent = nullptr);
+    ~RomSortFilterProxy();
+
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+    /**
+     * @brief Sorts by a view column; -1 restores the source order
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @brief Shows only rows matching a search, see RomSearchIndex; the view
+     *        is updated asynchronously once typing pauses
+     */
+    void setSearchText(const QString& text);
+
+private slots:
+    void onSourceAboutToBeReset();
+    void onSourceReset();
+    void onRowsInserted(const QModelIndex& parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void onRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void startSearch();
+
+private:
+    enum KeyType { NumberKey, RankKey, TextKey };
+    struct SearchState;
+
+    RomListModel* romModel() const;
+
+    // Sort keys, one per source row for the current sort column
+    void updateSortField();
+    void computeKeys();
+    bool appendKeys(int first, int last); // False if the ranks went stale
+    void computeRanks();
+    qint64 numberKey(int sourceRow) const;
+    quint32 internedId(int sourceRow) const;
+    QString textKey(int sourceRow) const;
+    bool lessThan(int leftRow, int rightRow) const;
+    void sortOrder();
+
+    // Search
+    void cancelSearch();
+    void searchTask(std::shared_ptr<SearchState> state);
+    void publishSearch(std::shared_ptr<SearchState> state);
+    void updateSearchIndex();
+    bool acceptsRow(int sourceRow) const;
+
+    // Sort and filter changes are published as one layout change; persistent
+    // indexes (selection, current item) follow their source rows
+    void beginLayoutChange();
+    void endLayoutChange();
+    void rebuildRows();
+    void rebuildSourceToProxy() const;
+
+    int m_sortColumn; // View column, -1 for source order
+    Qt::SortOrder m_sortOrder;
+    int m_sortField;  // RomListModel::RomColumns of m_sortColumn, -1 for source order
+    KeyType m_keyType;
+    QCollator m_collator;
+    QVector<qint64> m_numberKeys;             // NumberKey and RankKey
+    std::vector<QCollatorSortKey> m_textKeys; // TextKey
+    QHash<quint32, qint64> m_ranks;           // StringPool id -> collated rank
+
+    QStringList m_searchTerms;  // Search the accepted rows reflect
+    QStringList m_pendingTerms; // Search typed, applied once it has run
+    RomSearchIndex m_searchIndex;
+    quint64 m_sourceGeneration; // Bumped when source rows are removed or reset
+    bool m_searchOutdated;      // Source was reset under m_searchTerms; no rows accepted until searched again
+    QThreadPool m_searchPool;
+    QTimer m_searchTimer;
+    std::shared_ptr<SearchState> m_searchState;
+
+    QVector<int> m_order;     // All source rows in sort order
+    QVector<bool> m_accepted; // Per source row
+    QVector<int> m_rows;      // Proxy row -> source row
+    mutable QVector<int> m_sourceToProxy; // Source row -> proxy row, -1 if filtered out
+    mutable bool m_sourceToProxyDirty;
+
+    // Persistent indexes and their source rows across a layout change
+    QModelIndexList m_layoutIndexes;
+    QVector<int> m_layoutSourceRows;
+};
+
+} // namespace QT_UI
@@ -0,0 +1,182 @@
+#include "RomStore.h"
+#include "RomListModel.h"
+#include <QDateTime>
+#include <cstring>
+
+namespace QT_UI {
+
+static const int MD5_SIZE = 16;
+static const int SHA1_SIZE = 20;
+
+void RomStore::append(const RomInfo& info)
+{
+    m_fileName.append(info.fileName);
+    m_goodName.append(info.goodName);
+    m_internalName.append(info.internalName);
+    m_filePath.append(info.filePath);
+    m_memberName.append(info.memberName);
+    m_cartID.append(info.cartID);
+    m_cartridgeCode.append(info.cartridgeCode);
+    m_coverPath.append(info.coverPath);
+
+    StringPool& pool = StringPool::instance();
+    m_country.append(pool.intern(info.country));
+    m_releaseDate.append(pool.intern(info.releaseDate));
+    m_genre.append(pool.intern(info.genre));
+    m_developer.append(pool.intern(info.developer));
+    m_mediaType.append(pool.intern(info.mediaType));
+    m_status.append(pool.intern(info.status));
+
+    m_romSize.append(info.romSize);
+    m_crc1.append(info.crc1);
+    m_crc2.append(info.crc2);
+    m_players.append(static_cast<quint8>(qBound(0, info.players, 255)));
+    m_cicChip.append(static_cast<qint8>(info.cicChip));
+    m_playCount.append(info.playCount);
+    m_lastPlayed.append(info.lastPlayed.isValid() ? info.lastPlayed.toMSecsSinceEpoch() : 0);
+
+    quint8 flags = 0;
+    if (info.headerParsed) flags |= HeaderParsed;
+    if (info.isGoodDump) flags |= GoodDump;
+    if (info.checksumChecked) flags |= ChecksumChecked;
+    if (info.isVerifiedDump) flags |= VerifiedDump;
+    if (info.forceFeedback) flags |= ForceFeedback;
+    if (info.hasBeenPlayed) flags |= HasBeenPlayed;
+    if (info.hasCover) flags |= HasCover;
+    m_flags.append(flags);
+
+    m_fileCrc32.append(0);
+    m_md5.append(MD5_SIZE, '\0');
+    m_sha1.append(SHA1_SIZE, '\0');
+    if (!info.md5.isEmpty()) {
+        setHashes(size() - 1, info.md5, info.sha1, info.crc32);
+    }
+}
+
+void RomStore::removeAt(int row)
+{
+    m_fileName.removeAt(row);
+    m_goodName.removeAt(row);
+    m_internalName.removeAt(row);
+    m_filePath.removeAt(row);
+    m_memberName.removeAt(row);
+    m_cartID.removeAt(row);
+    m_cartridgeCode.removeAt(row);
+    m_coverPath.removeAt(row);
+    m_country.removeAt(row);
+    m_releaseDate.removeAt(row);
+    m_genre.removeAt(row);
+    m_developer.removeAt(row);
+    m_mediaType.removeAt(row);
+    m_status.removeAt(row);
+    m_romSize.removeAt(row);
+    m_crc1.removeAt(row);
+    m_crc2.removeAt(row);
+    m_fileCrc32.removeAt(row);
+    m_players.removeAt(row);
+    m_cicChip.removeAt(row);
+    m_flags.removeAt(row);
+    m_playCount.removeAt(row);
+    m_lastPlayed.removeAt(row);
+    m_md5.remove(row * MD5_SIZE, MD5_SIZE);
+    m_sha1.remove(row * SHA1_SIZE, SHA1_SIZE);
+}
+
+void RomStore::clear()
+{
+    *this = RomStore();
+}
+
+RomInfo RomStore::at(int row) const
+{
+    RomInfo info;
+    info.fileName = fileName(row);
+    info.goodName = goodName(row);
+    info.internalName = internalName(row);
+    info.filePath = filePath(row);
+    info.memberName = memberName(row);
+    info.cartID = cartID(row);
+    info.cartridgeCode = cartridgeCode(row);
+    info.coverPath = coverPath(row);
+    info.country = country(row);
+    info.releaseDate = releaseDate(row);
+    info.genre = genre(row);
+    info.developer = developer(row);
+    info.mediaType = mediaType(row);
+    info.status = status(row);
+    info.romSize = romSize(row);
+    info.crc1 = crc1(row);
+    info.crc2 = crc2(row);
+    info.players = players(row);
+    info.cicChip = cicChip(row);
+    info.md5 = md5(row);
+    info.sha1 = sha1(row);
+    info.crc32 = crc32(row);
+    info.headerParsed = hasFlag(row, HeaderParsed);
+    info.isGoodDump = hasFlag(row, GoodDump);
+    info.checksumChecked = hasFlag(row, ChecksumChecked);
+    info.isVerifiedDump = hasFlag(row, VerifiedDump);
+    info.forceFeedback = hasFlag(row, ForceFeedback);
+    info.hasBeenPlayed = hasFlag(row, HasBeenPlayed);
+    info.hasCover = hasFlag(row, HasCover);
+    info.playCount = m_playCount.at(row);
+    if (m_lastPlayed.at(row) != 0) {
+        info.lastPlayed = QDateTime::fromMSecsSinceEpoch(m_lastPlayed.at(row));
+    }
+    return info;
+}
+
+QString RomStore::key(int row) const
+{
+    return RomInfoProvider::romKey(filePath(row), memberName(row));
+}
+
+QString RomStore::md5(int row) const
+{
+    if (!hasFlag(row, Hashed))
+        return QString();
+    return QString::fromLatin1(m_md5.mid(row * MD5_SIZE, MD5_SIZE).toHex().toUpper());
+}
+
+QString RomStore::sha1(int row) const
+{
+    if (!hasFlag(row, Hashed))
+        return QString();
+    return QString::fromLatin1(m_sha1.mid(row * SHA1_SIZE, SHA1_SIZE).toHex().toUpper());
+}
+
+QString RomStore::crc32(int row) const
+{
+    if (!hasFlag(row, Hashed))
+        return QString();
+    return QString::number(m_fileCrc32.at(row), 16).rightJustified(8, '0').toUpper();
+}
+
+void RomStore::setFlag(int row, Flag flag, bool on)
+{
+    if (on)
+        m_flags[row] |= flag;
+    else
+        m_flags[row] &= static_cast<quint8>(~flag);
+}
+
+void RomStore::setHashes(int row, const QString& md5, const QString& sha1, const QString& crc32)
+{
+    const QByteArray md5Bytes = QByteArray::fromHex(md5.toLatin1());
+    const QByteArray sha1Bytes = QByteArray::fromHex(sha1.toLatin1());
+    if (md5Bytes.size() != MD5_SIZE || sha1Bytes.size() != SHA1_SIZE)
+        return;
+
+    memcpy(m_md5.data() + row * MD5_SIZE, md5Bytes.constData(), MD5_SIZE);
+    memcpy(m_sha1.data() + row * SHA1_SIZE, sha1Bytes.constData(), SHA1_SIZE);
+    m_fileCrc32[row] = crc32.toUInt(nullptr, 16);
+    setFlag(row, Hashed, true);
+}
+
+void RomStore::setCover(int row, const QString& coverPath, bool hasCover)
+{
+    m_coverPath[row] = coverPath;
+    setFlag(row, HasCover, hasCover);
+}
+
+} // namespace QT_UI
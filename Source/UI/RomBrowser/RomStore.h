@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <Core/RomParser.h>
+#include <Core/StringPool.h>
+
+namespace QT_UI {
+
+struct RomInfo;
+
+/**
+ * @brief Column-wise storage of the ROM library behind RomListModel
+ *
+ * Libraries can hold tens of thousands of ROMs, so rows are not kept as
+ * RomInfo records with two dozen strings each. Numbers, enums and flags are
+ * packed into one array per column, digests into flat byte blocks, and
+ * low-cardinality text (country, genre, developer, ...) is kept as ids into
+ * the process-wide StringPool, so every distinct value is stored once and
+ * equal values have equal ids. Formatting for display is left to the model.
+ *
+ * Not thread-safe; owned and used by the model on the GUI thread.
+ */
+class RomStore
+{
+public:
+    enum Flag : quint8 {
+        HeaderParsed  = 0x01, // Header fields (CRCs, CIC, ...) are known
+        GoodDump      = 0x02, // Only meaningful with ChecksumChecked
+        VerifiedDump  = 0x04,
+        ForceFeedback = 0x08,
+        HasBeenPlayed = 0x10,
+        HasCover      = 0x20,
+        Hashed        = 0x40, // MD5, SHA-1 and the file CRC32 are known
+        ChecksumChecked = 0x80 // The boot checksum was verified
+    };
+
+    int size() const { return m_filePath.size(); }
+    bool isEmpty() const { return m_filePath.isEmpty(); }
+    void append(const RomInfo& info);
+    void removeAt(int row);
+    void clear();
+
+    /**
+     * @brief Assembles the full record of a row
+     */
+    RomInfo at(int row) const;
+
+    // Text unique to each ROM
+    const QString& fileName(int row) const { return m_fileName.at(row); }
+    const QString& goodName(int row) const { return m_goodName.at(row); }
+    const QString& internalName(int row) const { return m_internalName.at(row); }
+    const QString& filePath(int row) const { return m_filePath.at(row); }
+    const QString& memberName(int row) const { return m_memberName.at(row); }
+    const QString& cartID(int row) const { return m_cartID.at(row); }
+    const QString& cartridgeCode(int row) const { return m_cartridgeCode.at(row); }
+    const QString& coverPath(int row) const { return m_coverPath.at(row); }
+    QString key(int row) const;
+
+    // Interned text
+    const QString& country(int row) const { return StringPool::instance().at(m_country.at(row)); }
+    const QString& releaseDate(int row) const { return StringPool::instance().at(m_releaseDate.at(row)); }
+    const QString& genre(int row) const { return StringPool::instance().at(m_genre.at(row)); }
+    const QString& developer(int row) const { return StringPool::instance().at(m_developer.at(row)); }
+    const QString& mediaType(int row) const { return StringPool::instance().at(m_mediaType.at(row)); }
+    const QString& status(int row) const { return StringPool::instance().at(m_status.at(row)); }
+
+    // StringPool ids of the interned text; equal ids mean equal values
+    quint32 countryId(int row) const { return m_country.at(row); }
+    quint32 releaseDateId(int row) const { return m_releaseDate.at(row); }
+    quint32 genreId(int row) const { return m_genre.at(row); }
+    quint32 developerId(int row) const { return m_developer.at(row); }
+    quint32 mediaTypeId(int row) const { return m_mediaType.at(row); }
+    quint32 statusId(int row) const { return m_status.at(row); }
+
+    // Packed values
+    qint64 romSize(int row) const { return m_romSize.at(row); }
+    quint32 crc1(int row) const { return m_crc1.at(row); }
+    quint32 crc2(int row) const { return m_crc2.at(row); }
+    int players(int row) const { return m_players.at(row); }
+    CICChip cicChip(int row) const { return static_cast<CICChip>(m_cicChip.at(row)); }
+    bool hasFlag(int row, Flag flag) const { return (m_flags.at(row) & flag) != 0; }
+
+    // Digests as uppercase hex, empty unless the row is Hashed
+    QString md5(int row) const;
+    QString sha1(int row) const;
+    QString crc32(int row) const;
+
+    void setFlag(int row, Flag flag, bool on);
+    void setHashes(int row, const QString& md5, const QString& sha1, const QString& crc32);
+    void setCover(int row, const QString& coverPath, bool hasCover);
+
+private:
+    QVector<QString> m_fileName;
+    QVector<QString> m_goodName;
+    QVector<QString> m_internalName;
+    QVector<QString> m_filePath;
+    QVector<QString> m_memberName;
+    QVector<QString> m_cartID;
+    QVector<QString> m_cartridgeCode;
+    QVector<QString> m_coverPath;
+
+    // StringPool ids
+    QVector<quint32> m_country;
+    QVector<quint32> m_releaseDate;
+    QVector<quint32> m_genre;
+    QVector<quint32> m_developer;
+    QVector<quint32> m_mediaType;
+    QVector<quint32> m_status;
+
+    QVector<qint64> m_romSize;
+    QVector<quint32> m_crc1;
+    QVector<quint32> m_crc2;
+    QVector<quint32> m_fileCrc32;
+    QVector<quint8> m_players;
+    QVector<qint8> m_cicChip;
+    QVector<quint8> m_flags;
+    QVector<qint32> m_playCount;
+    QVector<qint64> m_lastPlayed; // ms since epoch, 0 if never played
+
+    QByteArray m_md5;  // 16 bytes per row
+    QByteArray m_sha1; // 20 bytes per row
+};
+
+} // namespace QT_UI
@@ -77,6 +77,10 @@ void GeneralSettingsPage::setupUI()
     advancedLayout->addWidget(confirmOnResetCheck);
     advancedLayout->addWidget(confirmOnExitCheck);
     
+    m_loadDatabaseIntoMemoryCheck = new QCheckBox(tr("Load ROM database into memory at startup (requires restart)"));
+    advancedLayout->addWidget(m_loadDatabaseIntoMemoryCheck);
+    connect(m_loadDatabaseIntoMemoryCheck, &QCheckBox::toggled, this, &GeneralSettingsPage::settingsChanged);
+    
     mainLayout->addWidget(m_advancedGroup);
     mainLayout->addStretch();
     
@@ -96,6 +100,7 @@ void GeneralSettingsPage::loadSettings()
     m_hideAdvancedSettingsCheck->setChecked(appSettings->hideAdvancedSettings());
     m_maxRomsSpinBox->setValue(appSettings->maxRecentRoms());
     m_maxRomDirsSpinBox->setValue(appSettings->maxRecentRomDirs());
+    m_loadDatabaseIntoMemoryCheck->setChecked(appSettings->loadDatabaseIntoMemory());
     
     updateUI();
 }
@@ -112,6 +117,7 @@ void GeneralSettingsPage::saveSettings()
     appSettings->setHideAdvancedSettings(m_hideAdvancedSettingsCheck->isChecked());
     appSettings->setMaxRecentRoms(m_maxRomsSpinBox->value());
     appSettings->setMaxRecentRomDirs(m_maxRomDirsSpinBox->value());
+    appSettings->setLoadDatabaseIntoMemory(m_loadDatabaseIntoMemoryCheck->isChecked());
 }
 
 void GeneralSettingsPage::resetSettings()
@@ -123,6 +129,7 @@ void GeneralSettingsPage::resetSettings()
     m_hideAdvancedSettingsCheck->setChecked(false);
     m_maxRomsSpinBox->setValue(10);
     m_maxRomDirsSpinBox->setValue(10);
+    m_loadDatabaseIntoMemoryCheck->setChecked(true);
     
     updateUI();
     emit settingsChanged();
@@ -39,6 +39,7 @@ private:
     
     // Advanced settings group
     QGroupBox* m_advancedGroup;
+    QCheckBox* m_loadDatabaseIntoMemoryCheck;
 };
 
 } // namespace QT_UI
@@ -2,6 +2,7 @@
 #include "../../Core/Settings/SettingsManager.h"
 #include "../../Core/Settings/RomBrowserSettings.h"
 #include "../../Core/RomParser.h"
+#include "../../Core/RomInfoProvider.h"
 
 #include <QSettings>
 #include <QFileDialog>
@@ -42,11 +43,10 @@ CoverDownloader::CoverDownloader(QWidget *parent) :
     // Set the default base URL for GitHub repository
     m_baseUrl = "https://raw.githubusercontent.com/IanSkelskey/n64-covers/refs/heads/main/labels/";
     
-    // Create database manager instance
-    QString dbPath = QDir(QApplication::applicationDirPath()).filePath("database.sqlite");
-    m_dbManager = new DatabaseManager(dbPath);
+    // Use the shared database connection of the GUI thread
+    m_dbManager = &DatabaseManager::instance();
     
-    if (!m_dbManager->open()) {
+    if (!m_dbManager->isDatabaseLoaded()) {
         qWarning() << "Failed to open ROM database";
     }
     
@@ -63,11 +63,6 @@ CoverDownloader::~CoverDownloader()
     if (m_isDownloading) {
         saveSettings();
     }
-    
-    if (m_dbManager) {
-        m_dbManager->close();
-        delete m_dbManager;
-    }
 }
 
 void CoverDownloader::setupUi()
@@ -155,17 +150,28 @@ void CoverDownloader::loadSettings()
 
 bool CoverDownloader::parseRomHeader(const QString &romPath, QString &cartridgeCode, QString &romName)
 {
-    // Open the ROM file and read its header
-    QFile file(romPath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open ROM file:" << romPath;
-        return false;
+    QByteArray headerData;
+    if (RomInfoProvider::isArchive(romPath)) {
+        // ZIP and 7z archives: use the start of the first ROM inside, as the browser does
+        QVector<RomInfoProvider::ArchivedRom> roms;
+        if (!RomInfoProvider::readArchivedRoms(romPath, roms) || roms.isEmpty()) {
+            qWarning() << "No ROM found in archive:" << romPath;
+            return false;
+        }
+        headerData = roms.first().head;
+    } else {
+        // Open the ROM file and read its header
+        QFile file(romPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Failed to open ROM file:" << romPath;
+            return false;
+        }
+        
+        // Read first 4KB of the ROM (should be enough for header)
+        headerData = file.read(RomParser::BOOT_AREA_SIZE);
+        file.close();
     }
     
-    // Read first 4KB of the ROM (should be enough for header)
-    QByteArray headerData = file.read(4096);
-    file.close();
-    
     // Parse ROM header using RomParser
     RomParser parser;
     if (!parser.setRomData(headerData)) {
@@ -201,23 +207,23 @@ bool CoverDownloader::parseRomHeader(const QString &romPath, QString &cartridgeC
     
     if (m_dbManager && m_dbManager->isDatabaseLoaded()) {
         // Try to get cartridge code from database using CRC values first (most accurate)
-        std::map<QString, QVariant> romInfo = m_dbManager->getRomBrowserEntryByCRC(crc1, crc2, countryHex);
+        RomBrowserEntry entry = m_dbManager->findRomBrowserEntry(crc1, crc2, countryHex);
         
-        if (!romInfo.empty() && romInfo.count("cartridge_code") && romInfo["cartridge_code"].isValid()) {
+        if (entry.isValid()) {
             // Use the official cartridge code from database
-            cartridgeCode = romInfo["cartridge_code"].toString();
+            cartridgeCode = entry.cartridgeCode;
             qDebug() << "Found cartridge code in database:" << cartridgeCode << "for ROM ID:" << cartridgeID;
             
             // Also update the ROM name if available
-            if (romInfo.count("good_name") && romInfo["good_name"].isValid() && !romInfo["good_name"].toString().isEmpty()) {
-                romName = romInfo["good_name"].toString();
+            if (!entry.goodName.isEmpty()) {
+                romName = entry.goodName;
             }
             
             return true;
         }
         
         // Fallback: try lookup by cartridge ID from ROM header
-        romInfo = m_dbManager->getRomInfoByCartridgeCode(cartridgeID);
+        std::map<QString, QVariant> romInfo = m_dbManager->getRomInfoByCartridgeCode(cartridgeID);
         if (!romInfo.empty() && romInfo.count("cartridge_code") && romInfo["cartridge_code"].isValid()) {
             cartridgeCode = romInfo["cartridge_code"].toString();
             qDebug() << "Found cartridge code by ID lookup:" << cartridgeCode;
@@ -248,7 +254,7 @@ void CoverDownloader::scanRoms()
     updateStatus(tr("Scanning for ROMs in %1...").arg(m_romDirectory));
     
     // Scan ROM directory for N64 ROMs
-    QStringList romExtensions = {"*.z64", "*.v64", "*.n64", "*.zip"};
+    QStringList romExtensions = {"*.z64", "*.v64", "*.n64", "*.zip", "*.7z"};
     QDir romDir(m_romDirectory);
     QStringList romFiles = romDir.entryList(romExtensions, QDir::Files);
     
@@ -77,7 +77,7 @@ private:
     QString m_romDirectory;
     QString m_coverDirectory;
     
-    // Database manager
+    // Shared database manager of the GUI thread (not owned)
     DatabaseManager* m_dbManager;
 };
 
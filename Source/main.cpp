@@ -1,5 +1,8 @@
 #include "UI/mainwindow.h"
 #include "UIAbstractionLayer.h"
+#include "Core/DatabaseManager.h"
+#include "Core/Settings/SettingsManager.h"
+#include "Core/Settings/ApplicationSettings.h"
 #include <QApplication>
 #include <QFile>
 
@@ -15,6 +18,10 @@ int main(int argc, char *argv[])
     QApplication::setOrganizationName("Project64");
     QApplication::setOrganizationDomain("project64.org");
     
+    // Decide how the ROM database is opened before anything queries it
+    DatabaseManager::setUseMemorySnapshot(
+        SettingsManager::instance().application()->loadDatabaseIntoMemory());
+    
     // Initialize UI abstraction layer
     UIAbstractionLayer::instance().initialize();
     